@@ -0,0 +1,236 @@
+#include "AstImage.h"
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+static const char IMAGE_MAGIC[8] = {'S', 'V', 'A', '2', 'S', 'M', 'T', '\x1a'};
+
+bool is_ast_image(std::string_view data) {
+    return data.size() >= sizeof(IMAGE_MAGIC) && memcmp(data.data(), IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0;
+}
+
+// 写映像时的字符串驻留
+class StringPool {
+public:
+    uint32_t add(const std::string &text) {
+        auto inserted = index.emplace(text, static_cast<uint32_t>(entries.size()));
+        if (inserted.second) {
+            entries.push_back(ImageString{static_cast<uint32_t>(bytes.size()), static_cast<uint32_t>(text.size())});
+            bytes += text;
+        }
+        return inserted.first->second;
+    }
+
+    std::vector<ImageString> entries;
+    std::string bytes;
+
+private:
+    std::unordered_map<std::string, uint32_t> index;
+};
+
+static uint8_t node_flags(const ASTNode *node) {
+    switch (node->kind()) {
+        case NODE_LOGIC:
+            return static_cast<const LogicAndOrOperation *>(node)->get_op();
+        case NODE_OVERLAP:
+            return static_cast<const OverlapExpression *>(node)->is_delayed();
+        case NODE_COMPARE:
+            return static_cast<const CompareExpression *>(node)->get_compare_type();
+        default:
+            return 0;
+    }
+}
+
+void save_ast_image(const ASTNode *root, const std::string &file_name) {
+    std::vector<ImageNode> nodes;
+    std::vector<uint32_t> children;
+    StringPool strings;
+    std::unordered_map<const ASTNode *, uint32_t> index;
+
+    std::vector<std::pair<const ASTNode *, bool>> work{{root, false}};
+    while (!work.empty()) {
+        auto [node, visited] = work.back();
+        work.pop_back();
+        if (index.count(node)) {
+            continue;
+        }
+        if (!visited) {
+            work.push_back({node, true});
+            for (size_t i = node->child_count(); i != 0; i--) {
+                work.push_back({node->child(i - 1), false});
+            }
+            continue;
+        }
+        ImageNode packed{};
+        packed.kind = static_cast<uint8_t>(node->kind());
+        packed.flags = node_flags(node);
+        switch (node->kind()) {
+            case NODE_IDENTIFIER:
+                packed.value = strings.add(static_cast<const Identifier *>(node)->get_name());
+                break;
+            case NODE_BIT_VALUE:
+                packed.value = static_cast<uint32_t>(static_cast<const BitValue *>(node)->get_value());
+                break;
+            case NODE_DATA_VALUE:
+                packed.value = static_cast<const DataValue *>(node)->get_width();
+                packed.extra = strings.add(static_cast<const DataValue *>(node)->get_data());
+                break;
+            case NODE_BOOL_VALUE:
+                packed.value = static_cast<const BoolValue *>(node)->get_value();
+                break;
+            case NODE_DELAY:
+                packed.value = static_cast<const DelayControl *>(node)->get_delay();
+                packed.extra = static_cast<const DelayControl *>(node)->get_max_delay();
+                break;
+            case NODE_REPEAT:
+                packed.value = static_cast<const Repetition *>(node)->get_min();
+                packed.extra = static_cast<const Repetition *>(node)->get_max();
+                break;
+            default:
+                break;
+        }
+        packed.first_child = static_cast<uint32_t>(children.size());
+        packed.child_count = static_cast<uint32_t>(node->child_count());
+        for (size_t i = 0; i < node->child_count(); i++) {
+            children.push_back(index.at(node->child(i)));
+        }
+        index[node] = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(packed);
+    }
+
+    ImageHeader header{};
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = AST_IMAGE_VERSION;
+    header.node_count = static_cast<uint32_t>(nodes.size());
+    header.child_count = static_cast<uint32_t>(children.size());
+    header.string_count = static_cast<uint32_t>(strings.entries.size());
+    header.string_bytes = static_cast<uint32_t>(strings.bytes.size());
+
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(ImageNode));
+    out.write(reinterpret_cast<const char *>(children.data()), children.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char *>(strings.entries.data()), strings.entries.size() * sizeof(ImageString));
+    out.write(strings.bytes.data(), strings.bytes.size());
+    if (!out) {
+        throw std::runtime_error("cannot write " + file_name);
+    }
+}
+
+static void image_check(bool condition, const char *message) {
+    if (!condition) {
+        throw std::runtime_error(std::string("corrupt AST image: ") + message);
+    }
+}
+
+ASTNode *load_ast_image(std::string_view data, AstArena &arena) {
+    image_check(is_ast_image(data) && data.size() >= sizeof(ImageHeader), "bad header");
+    ImageHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.version != AST_IMAGE_VERSION) {
+        throw std::runtime_error("AST image version " + std::to_string(header.version) +
+                                 " is not supported (expected " + std::to_string(AST_IMAGE_VERSION) + ")");
+    }
+    const uint64_t nodes_at = sizeof(ImageHeader);
+    const uint64_t children_at = nodes_at + uint64_t(header.node_count) * sizeof(ImageNode);
+    const uint64_t strings_at = children_at + uint64_t(header.child_count) * sizeof(uint32_t);
+    const uint64_t bytes_at = strings_at + uint64_t(header.string_count) * sizeof(ImageString);
+    image_check(header.node_count != 0 && bytes_at + header.string_bytes <= data.size(), "truncated");
+
+    // mmap 的起始地址按页对齐, 各段都是 4 字节对齐, 可以直接按结构读取
+    auto nodes = reinterpret_cast<const ImageNode *>(data.data() + nodes_at);
+    auto children = reinterpret_cast<const uint32_t *>(data.data() + children_at);
+    auto strings = reinterpret_cast<const ImageString *>(data.data() + strings_at);
+    const char *bytes = data.data() + bytes_at;
+    auto string_at = [&](uint32_t id) {
+        image_check(id < header.string_count, "string index out of range");
+        image_check(uint64_t(strings[id].offset) + strings[id].size <= header.string_bytes, "string out of range");
+        return std::string_view(bytes + strings[id].offset, strings[id].size);
+    };
+
+    std::vector<ASTNode *> built(header.node_count);
+    std::vector<ASTNode *> operands;
+    SymbolTable &symbols = arena.symbols();
+    for (uint32_t i = 0; i < header.node_count; i++) {
+        const ImageNode &packed = nodes[i];
+        image_check(uint64_t(packed.first_child) + packed.child_count <= header.child_count, "child list out of range");
+        operands.clear();
+        for (uint32_t k = 0; k < packed.child_count; k++) {
+            uint32_t child = children[packed.first_child + k];
+            image_check(child < i, "child after parent");
+            operands.push_back(built[child]);
+        }
+        auto expect = [&](uint32_t count) { image_check(packed.child_count == count, "wrong child count"); };
+        auto child_kind = [&](uint32_t k, NodeKind kind) {
+            image_check(operands[k]->kind() == kind, "wrong child kind");
+        };
+        ASTNode *node = nullptr;
+        switch (packed.kind) {
+            case NODE_IDENTIFIER:
+                expect(0);
+                node = arena.make<Identifier>(symbols, symbols.intern(string_at(packed.value)));
+                break;
+            case NODE_BIT_VALUE:
+                expect(0);
+                node = arena.make<BitValue>(static_cast<int>(packed.value));
+                break;
+            case NODE_DATA_VALUE:
+                expect(0);
+                node = arena.make<DataValue>(packed.value, std::string(string_at(packed.extra)));
+                break;
+            case NODE_BOOL_VALUE:
+                expect(0);
+                node = arena.make<BoolValue>(packed.value != 0);
+                break;
+            case NODE_BIT_SELECT:
+                expect(2);
+                child_kind(0, NODE_IDENTIFIER);
+                child_kind(1, NODE_BIT_VALUE);
+                node = arena.make<BitSelect>(static_cast<Identifier *>(operands[0]), static_cast<BitValue *>(operands[1]));
+                break;
+            case NODE_RANGE_SELECT:
+                expect(3);
+                child_kind(0, NODE_IDENTIFIER);
+                child_kind(1, NODE_BIT_VALUE);
+                child_kind(2, NODE_BIT_VALUE);
+                node = arena.make<RangeSelect>(static_cast<Identifier *>(operands[0]), static_cast<BitValue *>(operands[1]),
+                                               static_cast<BitValue *>(operands[2]));
+                break;
+            case NODE_LOGIC:
+                image_check(packed.child_count >= 2 && packed.flags <= OP_OR, "bad logic node");
+                node = packed.child_count == 2
+                           ? arena.make<LogicAndOrOperation>(static_cast<BinaryOperator>(packed.flags), operands[0], operands[1])
+                           : arena.make<LogicAndOrOperation>(static_cast<BinaryOperator>(packed.flags), operands);
+                break;
+            case NODE_DELAY:
+                expect(2);
+                image_check(packed.value <= packed.extra, "bad delay range");
+                node = arena.make<DelayControl>(packed.value, packed.extra, operands[0], operands[1]);
+                break;
+            case NODE_REPEAT:
+                expect(1);
+                image_check(packed.value != 0 && packed.value <= packed.extra && !operands[0]->spans_cycles(),
+                            "bad repetition");
+                node = arena.make<Repetition>(operands[0], packed.value, packed.extra);
+                break;
+            case NODE_PAREN:
+                expect(1);
+                node = arena.make<ParenExpression>(operands[0]);
+                break;
+            case NODE_OVERLAP:
+                expect(2);
+                node = arena.make<OverlapExpression>(operands[0], operands[1], packed.flags != 0);
+                break;
+            case NODE_COMPARE:
+                expect(2);
+                image_check(packed.flags <= CompareExpression::GREATER, "bad compare type");
+                node = arena.make<CompareExpression>(operands[0], operands[1],
+                                                     static_cast<CompareExpression::CompareType>(packed.flags));
+                break;
+            default:
+                image_check(false, "unknown node kind");
+        }
+        built[i] = node;
+    }
+    return built.back();
+}
@@ -0,0 +1,51 @@
+//
+// 预编译的断言映像: 把解析好的 AST 存为带版本的二进制文件, 之后可以 mmap 读入直接展开,
+// 不再提取, 词法分析和解析. 同一断言换 Time 或 NeedFalse 重复运行时使用.
+//
+// 布局 (本机字节序, 各段 4 字节对齐):
+//   ImageHeader
+//   ImageNode[node_count]      后序排列, 子节点下标总小于父节点, 最后一个是根
+//   uint32_t[child_count]      各节点的子节点下标, 由 ImageNode::first_child 引用
+//   ImageString[string_count]  字符串表, 指向其后的字符数据
+//   char[string_bytes]
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include <cstdint>
+
+struct ImageHeader {
+    char magic[8];  // "SVA2SMT\x1a"
+    uint32_t version;
+    uint32_t node_count;
+    uint32_t child_count;
+    uint32_t string_count;
+    uint32_t string_bytes;
+    uint32_t reserved;
+};
+
+struct ImageNode {
+    uint8_t kind;     // NodeKind
+    uint8_t flags;    // 运算符 / 比较类型 / |=>
+    uint16_t reserved;
+    uint32_t value;   // 字符串编号, 位号, 位宽, (最小) 延时, 最少重复次数或布尔值
+    uint32_t extra;   // DataValue 的数据字符串编号, 最大延时或最多重复次数 ($ 为 UNBOUNDED)
+    uint32_t first_child;
+    uint32_t child_count;
+};
+
+struct ImageString {
+    uint32_t offset;
+    uint32_t size;
+};
+
+// 格式改变时递增, 旧映像会被拒绝
+constexpr uint32_t AST_IMAGE_VERSION = 2;
+
+bool is_ast_image(std::string_view data);
+
+// 写出 root 的映像, 失败时抛出 std::runtime_error
+void save_ast_image(const ASTNode *root, const std::string &file_name);
+
+// 在 arena 中重建映像中的 AST, 返回根节点; 映像损坏或版本不符时抛出 std::runtime_error
+ASTNode *load_ast_image(std::string_view data, AstArena &arena);
@@ -0,0 +1,229 @@
+#include "Batch.h"
+#include "SVA2SMT.h"
+#include "Cache.h"
+#include "ThreadPool.h"
+#include "Translator.h"
+#include "VerilogScanner.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+struct BatchOptions {
+    std::vector<std::string> inputs;
+    std::string output_dir = ".";
+    std::string module;
+    SmtInformation info;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+};
+
+struct BatchResult {
+    unsigned line = 0;
+    std::string module;
+    std::string output;
+    std::string error;  // 为空表示成功
+    double millis = 0;
+};
+
+static bool read_batch_options(int argc, char *argv[], BatchOptions &options) {
+    options.info.Time = 10;
+    options.info.NeedFalse = true;
+    for (int i = 0; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = i + 1 < argc;
+        if (option == "--manifest" && has_value) {
+            std::ifstream manifest(argv[++i]);
+            if (!manifest) {
+                std::cerr << "cannot open manifest " << argv[i] << std::endl;
+                return false;
+            }
+            std::string line;
+            while (getline(manifest, line)) {
+                line = line.substr(0, line.find('#'));
+                size_t head = line.find_first_not_of(" \t\r");
+                if (head != std::string::npos) {
+                    options.inputs.push_back(line.substr(head, line.find_last_not_of(" \t\r") + 1 - head));
+                }
+            }
+        } else if (option == "--out" && has_value) {
+            options.output_dir = argv[++i];
+        } else if (option == "--time" && has_value) {
+            options.info.Time = atoi(argv[++i]);
+        } else if (option == "--needfalse" && has_value) {
+            options.info.NeedFalse = atoi(argv[++i]) == 0;
+        } else if (option == "--module" && has_value) {
+            options.module = argv[++i];
+        } else if (option == "--jobs" && has_value) {
+            options.jobs = std::max(1, atoi(argv[++i]));
+        } else if (option == "--share-terms") {
+            options.info.ShareTerms = true;
+        } else if (option == "--simplify") {
+            options.info.Simplify = true;
+        } else if (option == "--cache" && has_value) {
+            options.info.CacheDirectory = argv[++i];
+        } else if (option == "--cache-size" && has_value) {
+            options.info.CacheLimit = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (option.compare(0, 2, "--") == 0) {
+            std::cerr << "unknown batch option: " << option << std::endl;
+            return false;
+        } else {
+            options.inputs.push_back(option);
+        }
+    }
+    return true;
+}
+
+// 目录递归展开为其中的 .v/.sv/.svh 文件, 按路径排序保证输出稳定
+static std::vector<std::string> collect_files(const std::vector<std::string> &inputs) {
+    std::vector<std::string> files;
+    for (const std::string &input : inputs) {
+        if (!fs::is_directory(input)) {
+            files.push_back(input);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto &entry : fs::recursive_directory_iterator(input)) {
+            std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".v" || extension == ".sv" || extension == ".svh")) {
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+static void translate_one(const AssertionSource &source, SmtInformation &info, TranslationCache *cache) {
+    Translator translator(info);
+    std::string key;
+    if (cache) {
+        key = TranslationCache::key(translator.tokenize(source.text), info);
+        if (cache->fetch(key, info.OutputFileName)) {
+            return;
+        }
+        unlink(info.OutputFileName.c_str());
+        translator.parse();
+    } else {
+        translator.parse(source.text);
+    }
+    if (info.Simplify) {
+        translator.simplify();
+    }
+    std::ofstream file(info.OutputFileName);
+    if (!file) {
+        throw std::runtime_error("cannot open " + info.OutputFileName);
+    }
+    {
+        StreamSink out(file);
+        translator.write(out);
+    }
+    file.close();
+    if (cache) {
+        cache->store(key, info.OutputFileName);
+    }
+}
+
+int run_batch(int argc, char *argv[]) {
+    BatchOptions options;
+    if (!read_batch_options(argc, argv, options)) {
+        return 2;
+    }
+    std::vector<std::string> files = collect_files(options.inputs);
+    fs::create_directories(options.output_dir);
+    std::unique_ptr<TranslationCache> cache;
+    if (!options.info.CacheDirectory.empty()) {
+        cache.reset(new TranslationCache(options.info.CacheDirectory, options.info.CacheLimit));
+    }
+
+    // 同名文件的输出加上序号区分
+    std::vector<std::string> stems;
+    std::map<std::string, unsigned> stem_count;
+    for (const std::string &file : files) {
+        std::string stem = fs::path(file).stem().string();
+        unsigned seen = stem_count[stem]++;
+        stems.push_back(seen == 0 ? stem : stem + "." + std::to_string(seen));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsed = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    const Clock::time_point batch_start = Clock::now();
+
+    // results[f] 在扫描任务中定长, 之后每个翻译任务只写自己的元素
+    std::vector<std::vector<BatchResult>> results(files.size());
+    {
+        WorkStealingPool pool(options.jobs);
+        for (size_t f = 0; f < files.size(); f++) {
+            pool.submit([&, f] {
+                Clock::time_point start = Clock::now();
+                std::shared_ptr<MappedFile> file;
+                std::vector<AssertionSource> properties;
+                try {
+                    file = std::make_shared<MappedFile>(files[f]);
+                    properties = scan_assert_properties(file->view());
+                    if (properties.empty()) {
+                        throw std::runtime_error("no assert property found");
+                    }
+                } catch (const std::exception &error) {
+                    results[f].push_back(BatchResult{0, "", "", error.what(), elapsed(start)});
+                    return;
+                }
+                results[f].resize(properties.size());
+                for (size_t k = 0; k < properties.size(); k++) {
+                    // 断言文本指向映射的文件, 任务持有 file 保证其有效
+                    pool.submit([&, f, k, file, source = properties[k]] {
+                        Clock::time_point start = Clock::now();
+                        BatchResult &result = results[f][k];
+                        result.line = source.line;
+                        result.module = source.module.empty() ? options.module : std::string(source.module);
+                        SmtInformation info = options.info;
+                        info.InputFileName = files[f];
+                        info.ModuleName = result.module;
+                        info.OutputFileName = (fs::path(options.output_dir) /
+                                               (stems[f] + "_" + std::to_string(k + 1) + ".smt2")).string();
+                        try {
+                            translate_one(source, info, cache.get());
+                            result.output = info.OutputFileName;
+                        } catch (const std::exception &error) {
+                            result.error = error.what();
+                        }
+                        result.millis = elapsed(start);
+                    });
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    size_t succeeded = 0;
+    size_t failed = 0;
+    for (size_t f = 0; f < files.size(); f++) {
+        for (const BatchResult &result : results[f]) {
+            if (result.error.empty()) {
+                succeeded++;
+                printf("ok    %s:%u  %s  %s  %.3f ms\n", files[f].c_str(), result.line,
+                       result.module.c_str(), result.output.c_str(), result.millis);
+            } else {
+                failed++;
+                printf("FAIL  %s:%u  %s  %.3f ms  %s\n", files[f].c_str(), result.line,
+                       result.module.c_str(), result.millis, result.error.c_str());
+            }
+        }
+    }
+    printf("%zu files, %zu assertions translated, %zu failed, %.3f ms total on %u threads\n",
+           files.size(), succeeded, failed, elapsed(batch_start), options.jobs);
+    if (cache) {
+        unsigned long long hits = cache->hits();
+        unsigned long long misses = cache->misses();
+        auto [total_hits, total_misses] = cache->commit_counters();
+        printf("cache: %llu hits, %llu misses (%llu hits, %llu misses in total)\n",
+               hits, misses, total_hits, total_misses);
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+//
+// 批量模式: 从多个文件/目录中提取所有 assert property, 在工作窃取线程池上并发翻译,
+// 每个断言写到单独的输出文件, 最后打印成功/失败和每项耗时.
+//
+// Using : SVA2SMT --batch [options] files-or-directories...
+//   --manifest FILE   read more inputs from FILE, one path per line ('#' starts a comment)
+//   --out DIR         output directory (default: .), files are named <stem>_<k>.smt2
+//   --time T          unroll bound (default: 10)
+//   --needfalse N     same meaning as the 5th positional argument (default: 0)
+//   --module NAME     module name used when an assertion is not inside a module
+//   --jobs N          worker threads (default: hardware concurrency)
+//   --share-terms     see main.cpp
+//   --simplify        see main.cpp
+//   --cache DIR       translation cache shared with single runs, see Cache.h
+//   --cache-size MB   cache size cap (default: 1024)
+//
+#pragma once
+
+int run_batch(int argc, char *argv[]);
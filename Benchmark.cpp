@@ -0,0 +1,248 @@
+//
+// 基准测试: 对合成断言分别测量 tokenize, build_ast 和 write_smt_lib2 的耗时, 吞吐量和内存,
+// 随断言大小和 Time 增长给出伸缩曲线, 结果写成 JSON 以便在提交之间比较.
+//
+// Using : sva2smt_bench [options]
+//   --out FILE        write results as JSON (default: stdout)
+//   --label TEXT      stored in the results, e.g. the commit being measured
+//   --shapes a,b,..   shapes to run (default: all, see SvaGenerator.h)
+//   --sizes n,m,..    leaf counts (default: 10,100,1000,10000)
+//   --times n,m,..    unroll bounds (default: 10,100,1000)
+//   --repeat N        keep the fastest of N runs of each phase (default: 3)
+//   --share-terms     also measure the --share-terms output
+//   --seed N          generator seed (default: 1)
+//   --quick           sizes 10,100 and times 10,100
+//         sva2smt_bench --generate SHAPE SIZE [SEED]   print a Verilog module with that assertion
+//
+#include "SVA2SMT.h"
+#include "SmtWriter.h"
+#include "SvaGenerator.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sys/resource.h>
+
+// 只计数, 不保存输出, 使 emit 阶段的测量不含写文件的开销
+class CountingSink : public SmtSink {
+public:
+    void write(const char *data, size_t size) override { bytes += size; }
+    size_t bytes = 0;
+};
+
+struct BenchOptions {
+    std::string output;
+    std::string label;
+    std::vector<AssertionShape> shapes = all_shapes();
+    std::vector<unsigned> sizes{10, 100, 1000, 10000};
+    std::vector<unsigned> times{10, 100, 1000};
+    unsigned repeat = 3;
+    bool share_terms = false;
+    uint64_t seed = 1;
+};
+
+struct BenchRecord {
+    std::string shape;
+    std::string mode;
+    unsigned size;
+    unsigned time;
+    size_t source_bytes;
+    size_t tokens;
+    size_t nodes;
+    size_t token_bytes;
+    size_t arena_bytes;
+    size_t output_bytes;
+    double tokenize_ns;
+    double parse_ns;
+    double emit_ns;
+    long max_rss_kb;
+};
+
+static std::vector<unsigned> parse_list(const char *text) {
+    std::vector<unsigned> values;
+    for (const char *p = text; *p; ) {
+        values.push_back(static_cast<unsigned>(strtoul(p, const_cast<char **>(&p), 10)));
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            break;
+        }
+    }
+    return values;
+}
+
+static long max_rss_kb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename Function>
+static double fastest_ns(unsigned repeat, Function &&function) {
+    double best = 0;
+    for (unsigned i = 0; i < repeat; i++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = (i == 0 || ns < best) ? ns : best;
+    }
+    return best;
+}
+
+static bool read_bench_options(int argc, char *argv[], BenchOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = i + 1 < argc;
+        if (option == "--out" && has_value) {
+            options.output = argv[++i];
+        } else if (option == "--label" && has_value) {
+            options.label = argv[++i];
+        } else if (option == "--shapes" && has_value) {
+            options.shapes.clear();
+            std::string list = argv[++i];
+            size_t head = 0;
+            while (head <= list.size()) {
+                size_t comma = std::min(list.find(',', head), list.size());
+                AssertionShape shape;
+                if (!parse_shape(list.substr(head, comma - head), shape)) {
+                    std::cerr << "unknown shape: " << list.substr(head, comma - head) << std::endl;
+                    return false;
+                }
+                options.shapes.push_back(shape);
+                head = comma + 1;
+            }
+        } else if (option == "--sizes" && has_value) {
+            options.sizes = parse_list(argv[++i]);
+        } else if (option == "--times" && has_value) {
+            options.times = parse_list(argv[++i]);
+        } else if (option == "--repeat" && has_value) {
+            options.repeat = std::max(1, atoi(argv[++i]));
+        } else if (option == "--share-terms") {
+            options.share_terms = true;
+        } else if (option == "--seed" && has_value) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--quick") {
+            options.sizes = {10, 100};
+            options.times = {10, 100};
+        } else {
+            std::cerr << "unknown option: " << option << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static BenchRecord run_case(AssertionShape shape, unsigned size, unsigned time, bool share_terms,
+                            const BenchOptions &options) {
+    std::string source = generate_assertion(shape, size, options.seed);
+    SmtInformation info;
+    info.ModuleName = "bench";
+    info.Time = time;
+    info.NeedFalse = true;
+    info.ShareTerms = share_terms;
+
+    BenchRecord record{};
+    record.shape = shape_name(shape);
+    record.mode = share_terms ? "share-terms" : "plain";
+    record.size = size;
+    record.time = time;
+    record.source_bytes = source.size();
+
+    std::vector<Token> tokens;
+    record.tokenize_ns = fastest_ns(options.repeat, [&] { tokens = tokenize(source); });
+    record.tokens = tokens.size();
+    record.token_bytes = tokens.capacity() * sizeof(Token);
+
+    AstArena arena;
+    ASTNode *root = nullptr;
+    record.parse_ns = fastest_ns(options.repeat, [&] {
+        arena.clear();
+        root = build_ast(tokens, arena);
+    });
+    record.nodes = arena.size();
+    record.arena_bytes = arena.bytes();
+
+    record.emit_ns = fastest_ns(options.repeat, [&] {
+        CountingSink sink;
+        write_smt_lib2(root, info, sink);
+        record.output_bytes = sink.bytes;
+    });
+    record.max_rss_kb = max_rss_kb();
+    return record;
+}
+
+// 字节每秒折算为 MB/s
+static double throughput(size_t bytes, double ns) {
+    return ns > 0 ? bytes * 1e3 / ns : 0;
+}
+
+static void write_json(std::ostream &out, const BenchOptions &options, const std::vector<BenchRecord> &records) {
+    out << "{\n  \"label\": \"" << options.label << "\",\n  \"seed\": " << options.seed
+        << ",\n  \"repeat\": " << options.repeat << ",\n  \"results\": [\n";
+    char line[1024];
+    for (size_t i = 0; i < records.size(); i++) {
+        const BenchRecord &r = records[i];
+        snprintf(line, sizeof(line),
+                 "    {\"shape\": \"%s\", \"mode\": \"%s\", \"size\": %u, \"time\": %u, "
+                 "\"source_bytes\": %zu, \"tokens\": %zu, \"nodes\": %zu, "
+                 "\"tokenize_ns\": %.0f, \"parse_ns\": %.0f, \"emit_ns\": %.0f, "
+                 "\"tokenize_mb_s\": %.2f, \"parse_tokens_per_s\": %.0f, \"emit_mb_s\": %.2f, "
+                 "\"token_bytes\": %zu, \"arena_bytes\": %zu, \"output_bytes\": %zu, \"max_rss_kb\": %ld}%s\n",
+                 r.shape.c_str(), r.mode.c_str(), r.size, r.time, r.source_bytes, r.tokens, r.nodes,
+                 r.tokenize_ns, r.parse_ns, r.emit_ns,
+                 throughput(r.source_bytes, r.tokenize_ns), r.parse_ns > 0 ? r.tokens * 1e9 / r.parse_ns : 0,
+                 throughput(r.output_bytes, r.emit_ns),
+                 r.token_bytes, r.arena_bytes, r.output_bytes, r.max_rss_kb,
+                 i + 1 == records.size() ? "" : ",");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 4 && std::string(argv[1]) == "--generate") {
+        AssertionShape shape;
+        if (!parse_shape(argv[2], shape)) {
+            std::cerr << "unknown shape: " << argv[2] << std::endl;
+            return 2;
+        }
+        uint64_t seed = argc >= 5 ? strtoull(argv[4], nullptr, 10) : 1;
+        std::cout << generate_module("bench", generate_assertion(shape, atoi(argv[3]), seed));
+        return 0;
+    }
+    BenchOptions options;
+    if (!read_bench_options(argc, argv, options)) {
+        return 2;
+    }
+
+    std::vector<BenchRecord> records;
+    for (AssertionShape shape : options.shapes) {
+        for (unsigned size : options.sizes) {
+            for (unsigned time : options.times) {
+                for (int share = 0; share <= (options.share_terms ? 1 : 0); share++) {
+                    try {
+                        records.push_back(run_case(shape, size, time, share != 0, options));
+                    } catch (const std::exception &error) {
+                        std::cerr << shape_name(shape) << " size " << size << ": " << error.what() << std::endl;
+                        continue;
+                    }
+                    const BenchRecord &r = records.back();
+                    fprintf(stderr, "%-12s %-11s size %6u time %5u  tokenize %10.0f ns  parse %10.0f ns  emit %12.0f ns  %zu bytes\n",
+                            r.shape.c_str(), r.mode.c_str(), r.size, r.time,
+                            r.tokenize_ns, r.parse_ns, r.emit_ns, r.output_bytes);
+                }
+            }
+        }
+    }
+
+    if (options.output.empty()) {
+        write_json(std::cout, options, records);
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "cannot open " << options.output << std::endl;
+            return 1;
+        }
+        write_json(out, options, records);
+    }
+    return 0;
+}
@@ -0,0 +1,697 @@
+#include "BtorWriter.h"
+#include "Profiler.h"
+#include "SortInference.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+static const int CONSTANT = -1;
+// 表达式的引用: 下标 * 2, 最低位为取反. 下标 0 是常量 true
+static const unsigned TRUE_REF = 0;
+static const unsigned FALSE_REF = 1;
+
+struct NodeTime {
+    const ASTNode *node;
+    unsigned time;
+    bool operator==(const NodeTime &other) const { return node == other.node && time == other.time; }
+};
+
+struct NodeTimeHash {
+    size_t operator()(const NodeTime &key) const {
+        return std::hash<const void *>()(key.node) * 31 + key.time;
+    }
+};
+
+// BTOR2 的一个节点. ready 为它在哪个周期给出 (节点, 时刻) 的值, 即其中最晚读取的信号的周期;
+// 不读信号的为 CONSTANT, 任何周期都可以直接使用
+struct BtorValue {
+    unsigned id;
+    unsigned width;
+    int ready;
+};
+
+// 写出之前的 Bool 表达式: and/or 的操作数是引用, 叶子是已写出的 1 位节点
+enum ExprKind {
+    EXPR_LEAF,
+    EXPR_AND,
+    EXPR_OR,
+};
+
+struct Expr {
+    ExprKind kind;
+    unsigned id;  // 叶子
+    int ready;    // and/or 为操作数中最晚的
+    std::vector<unsigned> children;
+};
+
+// 去掉括号后是否为位向量的值 (信号, 位选, 常量), 而不是 Bool 表达式
+static const ASTNode *strip_paren(const ASTNode *node) {
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    return node;
+}
+
+static bool is_value(const ASTNode *node) {
+    switch (strip_paren(node)->kind()) {
+        case NODE_IDENTIFIER:
+        case NODE_BIT_SELECT:
+        case NODE_RANGE_SELECT:
+        case NODE_DATA_VALUE:
+        case NODE_BIT_VALUE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 值中是否读取信号 (常量不需要延时)
+static bool reads_signal(const ASTNode *node) {
+    switch (strip_paren(node)->kind()) {
+        case NODE_IDENTIFIER:
+        case NODE_BIT_SELECT:
+        case NODE_RANGE_SELECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 行在生成时直接写出, 每行只引用之前的行. 运算节点按文本做结构哈希, 相同的只写一次.
+//
+// Bool 运算先建成表达式, 写出时操作数按 ready 从早到晚结合, 较早的部分经延时链对齐到下一个,
+// 所以寄存器出现在 ##N 和 |=> 的位置, 且多为 1 位. 未完成的义务链先由 normalize 改写,
+// 使寄存器数与延时之和成正比, 而不是与链长和延时的乘积成正比
+class BtorEncoder {
+public:
+    BtorEncoder(const ASTNode *root, const SmtInformation &info, SmtSink &out);
+
+    unsigned window() const { return cycles; }
+    // root 在步 0 的 Bool 值, 对齐到周期 window()
+    unsigned property(const ASTNode *root, bool negate);
+    // valid 和 bad, 在 property 之后调用
+    void write_bad(unsigned assertion);
+    BtorStats stats() const { return BtorStats{next_id - 1, states, cycles}; }
+
+private:
+    void collect(const ASTNode *root);
+    unsigned sort(unsigned width);
+    unsigned node(const std::string &text);
+    unsigned declare(const std::string &text);
+    std::string operands(const std::string &op, unsigned width, std::initializer_list<unsigned> args);
+    unsigned constant(bool value) { return node("const " + std::to_string(sort(1)) + (value ? " 1" : " 0")); }
+    unsigned delayed(unsigned id, unsigned width, unsigned delay);
+    unsigned at(const BtorValue &value, int ready);
+    unsigned make_not(unsigned id);
+    unsigned make_gate(bool is_and, unsigned left, unsigned right);
+
+    unsigned leaf(unsigned id, int ready);
+    unsigned combine(bool is_and, std::vector<unsigned> refs);
+    unsigned make_and(const std::vector<unsigned> &refs) { return combine(true, refs); }
+    unsigned make_or(const std::vector<unsigned> &refs) { return combine(false, refs); }
+    int ready(unsigned ref) const { return exprs[ref >> 1].ready; }
+    bool is_gate(unsigned ref, bool is_and) const;
+    void flatten(unsigned ref, bool is_and, std::vector<unsigned> &parts) const;
+    unsigned normalize(unsigned ref);
+    BtorValue materialize(unsigned ref);
+
+    unsigned compute(const ASTNode *node, unsigned time);
+    unsigned compute_delay(const DelayControl *node, unsigned time);
+    unsigned compute_compare(const CompareExpression *node, unsigned time);
+    BtorValue value(const ASTNode *node, unsigned time);
+    BtorValue signal(const Identifier *signal, unsigned time);
+    unsigned memo(const ASTNode *node, unsigned time) const { return literals.at(NodeTime{node, time}); }
+
+    const SmtInformation &info;
+    SmtSink &out;
+    std::map<std::string, std::string> sorts;
+    std::vector<NodeTime> order;  // 后序, 子节点在前
+    unsigned cycles = 0;
+    unsigned next_id = 1;
+    unsigned states = 0;
+    unsigned true_id = 0;
+    unsigned false_id = 0;
+    std::unordered_map<unsigned, unsigned> sort_ids;
+    std::unordered_map<std::string, unsigned> nodes;
+    std::unordered_map<unsigned, unsigned> negations;
+    std::unordered_map<NodeTime, unsigned, NodeTimeHash> literals;
+    std::unordered_map<unsigned, BtorValue> inputs;              // 符号 -> 输入
+    std::unordered_map<unsigned, std::string> names;             // 输入和 valid -> 寄存器名的前缀
+    std::unordered_map<unsigned, std::vector<unsigned>> chains;  // 节点 -> 各级延时, chains[id][k - 1] 延时 k 个周期
+
+    std::vector<Expr> exprs;
+    std::map<std::vector<unsigned>, unsigned> expr_index;  // {kind, id, ready + 1} 或 {kind, 操作数...} -> 下标
+    std::unordered_map<unsigned, unsigned> normalized;
+    std::unordered_set<unsigned> sealed;  // 分配时合并出的前缀, 嵌套时 flatten 不展开
+    std::unordered_map<unsigned, BtorValue> written;
+};
+
+BtorEncoder::BtorEncoder(const ASTNode *root, const SmtInformation &info, SmtSink &out)
+    : info(info), out(out), sorts(infer_signal_sorts(root, info)) {
+    collect(root);
+}
+
+// 后序遍历 (节点, 时刻), 与 CnfWriter 相同; 同时求出读取信号的最远周期
+void BtorEncoder::collect(const ASTNode *root) {
+    struct Frame {
+        const ASTNode *node;
+        unsigned time;
+        bool visited;
+    };
+    std::unordered_map<NodeTime, bool, NodeTimeHash> seen;
+    std::vector<Frame> work{{root, 0, false}};
+    while (!work.empty()) {
+        Frame frame = work.back();
+        work.pop_back();
+        NodeTime key{frame.node, frame.time};
+        if (frame.visited) {
+            order.push_back(key);
+            continue;
+        }
+        if (!seen.emplace(key, true).second) {
+            continue;
+        }
+        work.push_back({frame.node, frame.time, true});
+        if (is_value(frame.node)) {
+            if (reads_signal(frame.node)) {
+                cycles = std::max(cycles, frame.time / TIME_CLOCK);
+            }
+            continue;
+        }
+        for (size_t i = 0; i < frame.node->child_count(); i++) {
+            const ASTNode *child = frame.node->child(i);
+            unsigned first = frame.node->child_time(i, frame.time);
+            // 比较的位向量操作数在比较节点里直接求值
+            if (frame.node->kind() == NODE_COMPARE && is_value(child)) {
+                if (reads_signal(child)) {
+                    cycles = std::max(cycles, first / TIME_CLOCK);
+                }
+                continue;
+            }
+            for (unsigned k = 0, span = frame.node->child_span(i, info.Time); k < span; k++) {
+                work.push_back({child, first + k * TIME_CLOCK, false});
+            }
+        }
+    }
+}
+
+unsigned BtorEncoder::declare(const std::string &text) {
+    unsigned id = next_id++;
+    out << std::to_string(id) << " " << text << "\n";
+    return id;
+}
+
+unsigned BtorEncoder::node(const std::string &text) {
+    auto found = nodes.find(text);
+    if (found != nodes.end()) {
+        return found->second;
+    }
+    unsigned id = declare(text);
+    nodes.emplace(text, id);
+    return id;
+}
+
+unsigned BtorEncoder::sort(unsigned width) {
+    auto found = sort_ids.find(width);
+    if (found != sort_ids.end()) {
+        return found->second;
+    }
+    unsigned id = declare("sort bitvec " + std::to_string(width));
+    sort_ids.emplace(width, id);
+    return id;
+}
+
+std::string BtorEncoder::operands(const std::string &op, unsigned width, std::initializer_list<unsigned> args) {
+    std::string text = op + " " + std::to_string(sort(width));
+    for (unsigned arg : args) {
+        text += " " + std::to_string(arg);
+    }
+    return text;
+}
+
+// id 延时 delay 个周期的值, 初值为 0; 延时链按需加长
+unsigned BtorEncoder::delayed(unsigned id, unsigned width, unsigned delay) {
+    if (delay == 0) {
+        return id;
+    }
+    std::vector<unsigned> &chain = chains[id];
+    const std::string sort_id = std::to_string(sort(width));
+    auto name = names.find(id);
+    while (chain.size() < delay) {
+        unsigned previous = chain.empty() ? id : chain.back();
+        unsigned zero = node("zero " + sort_id);
+        std::string state = "state " + sort_id;
+        if (name != names.end()) {
+            state += " " + name->second + "_delay" + std::to_string(chain.size() + 1);
+        }
+        unsigned register_id = declare(state);
+        declare("init " + sort_id + " " + std::to_string(register_id) + " " + std::to_string(zero));
+        declare("next " + sort_id + " " + std::to_string(register_id) + " " + std::to_string(previous));
+        chain.push_back(register_id);
+        states++;
+    }
+    return chain[delay - 1];
+}
+
+// value 在周期 ready 时的节点; ready 不早于 value.ready
+unsigned BtorEncoder::at(const BtorValue &value, int ready) {
+    return value.ready == CONSTANT ? value.id : delayed(value.id, value.width, ready - value.ready);
+}
+
+unsigned BtorEncoder::make_not(unsigned id) {
+    auto found = negations.find(id);
+    if (found != negations.end()) {
+        return found->second;
+    }
+    unsigned result = node(operands("not", 1, {id}));
+    negations.emplace(id, result);
+    negations.emplace(result, id);
+    return result;
+}
+
+unsigned BtorEncoder::make_gate(bool is_and, unsigned left, unsigned right) {
+    const unsigned unit = is_and ? true_id : false_id;
+    const unsigned zero = is_and ? false_id : true_id;
+    auto negation = negations.find(left);
+    if (left == zero || right == zero || (negation != negations.end() && negation->second == right)) {
+        return zero;
+    }
+    if (left == unit || left == right) {
+        return right;
+    }
+    if (right == unit) {
+        return left;
+    }
+    return node(operands(is_and ? "and" : "or", 1, {std::min(left, right), std::max(left, right)}));
+}
+
+unsigned BtorEncoder::leaf(unsigned id, int ready) {
+    if (id == true_id || id == false_id) {
+        return id == true_id ? TRUE_REF : FALSE_REF;
+    }
+    std::vector<unsigned> key{EXPR_LEAF, id, static_cast<unsigned>(ready + 1)};
+    auto found = expr_index.find(key);
+    if (found != expr_index.end()) {
+        return found->second << 1;
+    }
+    exprs.push_back(Expr{EXPR_LEAF, id, ready, {}});
+    expr_index.emplace(std::move(key), exprs.size() - 1);
+    return (exprs.size() - 1) << 1;
+}
+
+// n 元 and/or, 折叠常量, 重复和互补的操作数
+unsigned BtorEncoder::combine(bool is_and, std::vector<unsigned> refs) {
+    const unsigned unit = is_and ? TRUE_REF : FALSE_REF;
+    const unsigned zero = unit ^ 1;
+    std::sort(refs.begin(), refs.end());
+    refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+    refs.erase(std::remove(refs.begin(), refs.end(), unit), refs.end());
+    for (unsigned ref : refs) {
+        if (ref == zero || std::binary_search(refs.begin(), refs.end(), ref ^ 1)) {
+            return zero;
+        }
+    }
+    if (refs.empty()) {
+        return unit;
+    }
+    if (refs.size() == 1) {
+        return refs[0];
+    }
+    std::vector<unsigned> key{static_cast<unsigned>(is_and ? EXPR_AND : EXPR_OR)};
+    key.insert(key.end(), refs.begin(), refs.end());
+    auto found = expr_index.find(key);
+    if (found != expr_index.end()) {
+        return found->second << 1;
+    }
+    int latest = CONSTANT;
+    for (unsigned ref : refs) {
+        latest = std::max(latest, ready(ref));
+    }
+    exprs.push_back(Expr{is_and ? EXPR_AND : EXPR_OR, 0, latest, std::move(refs)});
+    expr_index.emplace(std::move(key), exprs.size() - 1);
+    return (exprs.size() - 1) << 1;
+}
+
+// 去掉取反后是否为 and (is_and) 或 or; 取反的 and 按 or 算, 反之亦然
+bool BtorEncoder::is_gate(unsigned ref, bool is_and) const {
+    const Expr &expr = exprs[ref >> 1];
+    return expr.kind != EXPR_LEAF && ((expr.kind == EXPR_AND) != static_cast<bool>(ref & 1)) == is_and;
+}
+
+// 嵌套的同种运算按从左到右展开为一层操作数; 分配时合并出的前缀 (sealed) 在嵌套处不展开
+void BtorEncoder::flatten(unsigned ref, bool is_and, std::vector<unsigned> &parts) const {
+    std::vector<unsigned> work{ref};
+    while (!work.empty()) {
+        unsigned current = work.back();
+        work.pop_back();
+        if (!is_gate(current, is_and) || (current != ref && sealed.count(current >> 1))) {
+            parts.push_back(current);
+            continue;
+        }
+        const std::vector<unsigned> &children = exprs[current >> 1].children;
+        for (size_t i = children.size(); i != 0; i--) {
+            work.push_back(children[i - 1] ^ (current & 1));
+        }
+    }
+}
+
+// 形如 l && !(r1 && !(r2 ...)) 的义务链: 最晚的操作数是另一种运算的 (e || L), e 是叶子且不早于其余操作数 P,
+// L 更晚并且是本运算. 这时把 P 分配进两个分支:
+//   P && (e || L)  =>  (P && e) || (P && L)
+// P && e 在 e 的周期就得出, P && L 合并 L 的操作数后继续向后传, 寄存器数与延时之和成正比;
+// 不分配时 P 和 e 都要一直延时到 L 的周期. 其余情况 (如区间展开的多个分支) 分配只会重复 P, 不做.
+// P 合并为一个操作数并标为 sealed, 链上后面的分配不再展开它, 否则每一步都要复制越来越长的 P.
+// 与 ExpandStack 相同用显式的栈, 机器生成的深层嵌套不会耗尽调用栈
+unsigned BtorEncoder::normalize(unsigned root) {
+    struct Frame {
+        unsigned ref;
+        bool expanded;
+        bool is_and;                     // 结果的运算
+        std::vector<unsigned> operands;  // 展开后为待化简的操作数
+    };
+    auto done = [this](unsigned ref) {
+        return exprs[ref >> 1].kind == EXPR_LEAF || normalized.count(ref) != 0;
+    };
+    auto result_of = [this](unsigned ref) {
+        return exprs[ref >> 1].kind == EXPR_LEAF ? ref : normalized.at(ref);
+    };
+    std::vector<Frame> work;
+    if (!done(root)) {
+        work.push_back({root, false, false, {}});
+    }
+    while (!work.empty()) {
+        Frame &frame = work.back();
+        if (frame.expanded) {
+            for (unsigned &operand : frame.operands) {
+                operand = result_of(operand);
+            }
+            unsigned result = combine(frame.is_and, std::move(frame.operands));
+            normalized.emplace(frame.ref, result);
+            work.pop_back();
+            continue;
+        }
+        if (done(frame.ref)) {
+            work.pop_back();
+            continue;
+        }
+        const unsigned ref = frame.ref;
+        const bool is_and = (exprs[ref >> 1].kind == EXPR_AND) != static_cast<bool>(ref & 1);
+        std::vector<unsigned> parts;
+        flatten(ref, is_and, parts);
+        auto latest = std::max_element(parts.begin(), parts.end(), [this](unsigned left, unsigned right) {
+            return ready(left) < ready(right);
+        });
+        const unsigned last = *latest;
+        parts.erase(latest);
+        int before = CONSTANT;
+        for (unsigned part : parts) {
+            before = std::max(before, ready(part));
+        }
+        std::vector<unsigned> branches;
+        if (!parts.empty() && before < ready(last) && is_gate(last, !is_and)) {
+            flatten(last, !is_and, branches);
+            if (branches.size() == 2 && ready(branches[0]) > ready(branches[1])) {
+                std::swap(branches[0], branches[1]);
+            }
+        }
+        std::vector<unsigned> operands;
+        bool result_and = is_and;
+        if (branches.size() == 2 && exprs[branches[0] >> 1].kind == EXPR_LEAF && before <= ready(branches[0]) &&
+            ready(branches[0]) < ready(branches[1]) && is_gate(branches[1], is_and)) {
+            unsigned previous = combine(is_and, std::move(parts));
+            if (is_gate(previous, is_and)) {
+                sealed.insert(previous >> 1);
+            }
+            for (unsigned branch : branches) {
+                operands.push_back(combine(is_and, {previous, branch}));
+            }
+            result_and = !is_and;
+        } else {
+            operands = std::move(parts);
+            operands.push_back(last);
+        }
+        frame.expanded = true;
+        frame.is_and = result_and;
+        frame.operands = std::move(operands);
+        // 压栈会使 frame 失效, 按下标访问; 逆序压入, 从左到右化简
+        const size_t index = work.size() - 1;
+        for (size_t i = work[index].operands.size(); i != 0; i--) {
+            unsigned operand = work[index].operands[i - 1];
+            if (!done(operand)) {
+                work.push_back({operand, false, false, {}});
+            }
+        }
+    }
+    return result_of(root);
+}
+
+// 写出表达式, 操作数按 ready 从早到晚结合, 每次把已结合的部分延时到下一个操作数的 ready
+BtorValue BtorEncoder::materialize(unsigned root) {
+    std::vector<std::pair<unsigned, bool>> work{{root, false}};
+    while (!work.empty()) {
+        auto [ref, expanded] = work.back();
+        if (written.count(ref)) {
+            work.pop_back();
+            continue;
+        }
+        const Expr &expr = exprs[ref >> 1];
+        if (expr.kind == EXPR_LEAF) {
+            written.emplace(ref, BtorValue{ref & 1 ? make_not(expr.id) : expr.id, 1, expr.ready});
+            work.pop_back();
+            continue;
+        }
+        const bool is_and = (expr.kind == EXPR_AND) != static_cast<bool>(ref & 1);
+        std::vector<unsigned> parts;
+        flatten(ref, is_and, parts);
+        if (!expanded) {
+            work.back().second = true;
+            for (size_t i = parts.size(); i != 0; i--) {
+                if (!written.count(parts[i - 1])) {
+                    work.push_back({parts[i - 1], false});
+                }
+            }
+            continue;
+        }
+        work.pop_back();
+        std::vector<BtorValue> values;
+        for (unsigned part : parts) {
+            values.push_back(written.at(part));
+        }
+        std::sort(values.begin(), values.end(), [](const BtorValue &left, const BtorValue &right) {
+            return left.ready != right.ready ? left.ready < right.ready : left.id < right.id;
+        });
+        BtorValue result = values[0];
+        for (size_t i = 1; i < values.size(); i++) {
+            int latest = std::max(result.ready, values[i].ready);
+            result = BtorValue{make_gate(is_and, at(result, latest), at(values[i], latest)), 1, latest};
+        }
+        written.emplace(ref, result);
+    }
+    return written.at(root);
+}
+
+// 信号在 time 时刻的值就是输入本身, 在周期 time / TIME_CLOCK 给出
+BtorValue BtorEncoder::signal(const Identifier *signal, unsigned time) {
+    auto found = inputs.find(signal->get_symbol());
+    if (found == inputs.end()) {
+        auto sort = sorts.find(signal->get_name());
+        unsigned width = sort == sorts.end() ? 0 : sort_width(sort->second);
+        if (width == 0) {
+            throw std::runtime_error("cannot infer the width of " + signal->get_name() + ", give it with --sort");
+        }
+        std::string name = "testbench." + info.ModuleName + "_instance." + signal->get_name();
+        unsigned id = declare("input " + std::to_string(this->sort(width)) + " " + name);
+        names.emplace(id, name);
+        found = inputs.emplace(signal->get_symbol(), BtorValue{id, width, CONSTANT}).first;
+    }
+    return BtorValue{found->second.id, found->second.width, static_cast<int>(time / TIME_CLOCK)};
+}
+
+BtorValue BtorEncoder::value(const ASTNode *node, unsigned time) {
+    node = strip_paren(node);
+    switch (node->kind()) {
+        case NODE_IDENTIFIER:
+            return signal(static_cast<const Identifier *>(node), time);
+        case NODE_BIT_SELECT: {
+            auto select = static_cast<const BitSelect *>(node);
+            BtorValue variable = signal(select->get_variable(), time);
+            if (static_cast<unsigned>(select->get_bit()) >= variable.width) {
+                throw std::runtime_error("bit select out of range: " + select->to_string());
+            }
+            std::string bit = std::to_string(select->get_bit());
+            return BtorValue{this->node(operands("slice", 1, {variable.id}) + " " + bit + " " + bit), 1,
+                             variable.ready};
+        }
+        case NODE_RANGE_SELECT: {
+            auto select = static_cast<const RangeSelect *>(node);
+            BtorValue variable = signal(select->get_variable(), time);
+            if (select->get_lsb() > select->get_msb() || static_cast<unsigned>(select->get_msb()) >= variable.width) {
+                throw std::runtime_error("range select out of range: " + select->to_string());
+            }
+            unsigned width = select->get_msb() - select->get_lsb() + 1;
+            return BtorValue{this->node(operands("slice", width, {variable.id}) + " " +
+                                        std::to_string(select->get_msb()) + " " + std::to_string(select->get_lsb())),
+                             width, variable.ready};
+        }
+        case NODE_DATA_VALUE: {
+            // 最高位在前, 与 BTOR2 的二进制常量相同; x/z 按 0 处理
+            std::string bits = static_cast<const DataValue *>(node)->get_data();
+            for (char &bit : bits) {
+                bit = bit == '1' ? '1' : '0';
+            }
+            unsigned width = static_cast<unsigned>(bits.size());
+            return BtorValue{this->node("const " + std::to_string(sort(width)) + " " + bits), width, CONSTANT};
+        }
+        case NODE_BIT_VALUE: {
+            // 不带位宽的整数, 取能表示它的最少位数
+            unsigned value = static_cast<unsigned>(static_cast<const BitValue *>(node)->get_value());
+            std::string bits;
+            do {
+                bits.insert(bits.begin(), value & 1 ? '1' : '0');
+                value >>= 1;
+            } while (value != 0);
+            unsigned width = static_cast<unsigned>(bits.size());
+            return BtorValue{this->node("const " + std::to_string(sort(width)) + " " + bits), width, CONSTANT};
+        }
+        default:
+            // Bool 表达式作为 1 位的值
+            return materialize(normalize(memo(node, time)));
+    }
+}
+
+unsigned BtorEncoder::compute_compare(const CompareExpression *node, unsigned time) {
+    BtorValue left = value(node->child(0), time);
+    BtorValue right = value(node->child(1), time);
+    int ready = std::max(left.ready, right.ready);
+    // 位宽不同时高位补 0
+    unsigned width = std::max(left.width, right.width);
+    for (BtorValue *operand : {&left, &right}) {
+        operand->id = at(*operand, ready);
+        if (operand->width < width) {
+            operand->id = this->node(operands("uext", width, {operand->id}) + " " +
+                                     std::to_string(width - operand->width));
+        }
+    }
+    const char *op;
+    switch (node->get_compare_type()) {
+        case CompareExpression::EQUAL:
+            op = "eq";
+            break;
+        case CompareExpression::NEQUAL:
+            op = "neq";
+            break;
+        case CompareExpression::LESS:
+            op = "ult";
+            break;
+        case CompareExpression::GREATER:
+            op = "ugt";
+            break;
+        case CompareExpression::LEQUAL:
+            op = "ulte";
+            break;
+        default:
+            op = "ugte";
+            break;
+    }
+    return leaf(this->node(operands(op, 1, {left.id, right.id})), ready);
+}
+
+// 与 DelayControl::emit_range 等价, 但按左操作数的每个结束周期 j 列出窗口:
+//   R_j = (or E_j (and b@j R_{j+1})),  R_last = E_last,  E_j = (or r@(j-1+delay) ... r@(j-1+max))
+// 监视器里信号不带时刻, 各个 E_j 只是同一个电路错开若干周期, 按结构哈希后写出的节点和寄存器与
+// 区间宽度成线性. emit_range 的链式写法在这里反而不好: normalize 会把每段 b 的前缀分配出去,
+// 各自延时 max 个周期, 寄存器数变为平方
+unsigned BtorEncoder::compute_delay(const DelayControl *node, unsigned time) {
+    const unsigned horizon = info.Time;
+    const Repetition *repetition = node->left_repetition();
+    const unsigned first = repetition ? repetition->get_min() : 1;
+    const unsigned last = repetition ? repetition->get_max(horizon) : 1;
+    const unsigned high = node->get_max_delay(horizon);
+    const ASTNode *right = node->child(1);
+
+    unsigned rest = FALSE_REF;
+    for (unsigned j = last; j >= first; j--) {
+        unsigned end = time + (j - 1) * TIME_CLOCK;
+        std::vector<unsigned> window;
+        for (unsigned k = node->get_delay(); k <= high; k++) {
+            window.push_back(memo(right, end + k * TIME_CLOCK));
+        }
+        unsigned ends_here = make_or(window);
+        rest = j == last ? ends_here
+                         : make_or({ends_here, make_and({memo(repetition->get_operand(), time + j * TIME_CLOCK), rest})});
+    }
+    return make_and({memo(node->child(0), time), info.NeedFalse ? rest ^ 1 : rest});
+}
+
+unsigned BtorEncoder::compute(const ASTNode *node, unsigned time) {
+    if (is_value(node)) {
+        // Bool 上下文中的值: 非 0 为真
+        BtorValue bits = value(node, time);
+        return leaf(bits.width == 1 ? bits.id : this->node(operands("redor", 1, {bits.id})), bits.ready);
+    }
+    switch (node->kind()) {
+        case NODE_PAREN:
+            return memo(node->child(0), time);
+        case NODE_BOOL_VALUE:
+            return static_cast<const BoolValue *>(node)->get_value() ? TRUE_REF : FALSE_REF;
+        case NODE_LOGIC: {
+            std::vector<unsigned> inputs;
+            for (size_t i = 0; i < node->child_count(); i++) {
+                inputs.push_back(memo(node->child(i), time));
+            }
+            return static_cast<const LogicAndOrOperation *>(node)->get_op() == OP_AND ? make_and(inputs)
+                                                                                      : make_or(inputs);
+        }
+        case NODE_DELAY:
+            return compute_delay(static_cast<const DelayControl *>(node), time);
+        case NODE_OVERLAP: {
+            unsigned right = memo(node->child(1), node->child_time(1, time));
+            return make_and({memo(node->child(0), time), info.NeedFalse ? right ^ 1 : right});
+        }
+        case NODE_REPEAT: {
+            auto repetition = static_cast<const Repetition *>(node);
+            std::vector<unsigned> inputs;
+            for (unsigned i = 0; i < repetition->get_min(); i++) {
+                inputs.push_back(memo(repetition->get_operand(), time + i * TIME_CLOCK));
+            }
+            return make_and(inputs);
+        }
+        case NODE_COMPARE:
+            return compute_compare(static_cast<const CompareExpression *>(node), time);
+        default:
+            throw std::runtime_error("cannot translate to BTOR2: " + node->to_string());
+    }
+}
+
+unsigned BtorEncoder::property(const ASTNode *root, bool negate) {
+    true_id = constant(true);
+    false_id = constant(false);
+    negations.emplace(true_id, false_id);
+    negations.emplace(false_id, true_id);
+    exprs.push_back(Expr{EXPR_LEAF, true_id, CONSTANT, {}});  // TRUE_REF
+    for (const NodeTime &key : order) {
+        literals.emplace(key, compute(key.node, key.time));
+    }
+    unsigned value = memo(root, 0);
+    return at(materialize(normalize(negate ? value ^ 1 : value)), static_cast<int>(cycles));
+}
+
+// valid 为常量 1 延时 window() 个周期, 即从周期 window() 起为 1
+void BtorEncoder::write_bad(unsigned assertion) {
+    names.emplace(true_id, "valid");
+    unsigned valid = delayed(true_id, 1, cycles);
+    declare("bad " + std::to_string(make_gate(true, valid, assertion)));
+}
+
+BtorStats write_btor2(const ASTNode *root, const SmtInformation &info, SmtSink &out) {
+    const bool negate = info.NegateRoot >= 0 ? info.NegateRoot != 0 : info.NeedFalse && !root->has_overlap();
+    BtorEncoder encoder(root, info, out);
+    ProfileScope scope("write_btor2");
+    out << "; SVA2SMT " << info.ModuleName << " time " << info.Time << " window " << encoder.window()
+        << ": bad at cycle c is Assert_<2(c-" << encoder.window() << ")+1>\n";
+    encoder.write_bad(encoder.property(root, negate));
+    BtorStats stats = encoder.stats();
+    profile_count("btor2_nodes", stats.nodes);
+    profile_count("btor2_states", stats.states);
+    return stats;
+}
@@ -0,0 +1,27 @@
+//
+// 时序后端: 不展开, 把断言一次性翻译成 BTOR2 转移系统上的监视器, 交给 btormc, pono, AVR 等
+// 模型检查器做 BMC 或 k-induction. 输出大小与展开界无关, 只与断言和其中的延时有关.
+//
+// 断言在步 t 读取的信号最远到 t + D 个周期, 监视器在周期 t + D 判断步 t: 每个运算在其操作数中
+// 最晚的信号到来时求值, 较早得出的部分经 1 位的延时寄存器等待 (##N 处为 N 级, |=> 处为 1 级),
+// 求值方式与 write_smt_lib2 相同. 前 D 个周期没有完整的窗口, 用 D 级移位寄存器给出的 valid 屏蔽.
+//   bad 在周期 c 为真  <=>  write_smt_lib2 的 Assert_<2(c-D)+1> 为真
+// 所以 SMT-LIB2 输出在界 Time 内可满足, 当且仅当监视器在 D + Time/2 个周期内可达 bad.
+// 区间和重复中的 $ 仍按 info.Time 取值.
+//
+// 信号位宽取自 infer_signal_sorts, Bool 为 1 位的位向量. 输入命名为 testbench.<module>_instance.<signal>,
+// 输入本身的延时寄存器在其后加 _delay<k>, valid 的为 valid_delay<k>.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include "SmtEmitter.h"
+
+struct BtorStats {
+    unsigned nodes = 0;   // 行数 (不含注释)
+    unsigned states = 0;  // 延时寄存器和 valid 寄存器
+    unsigned window = 0;  // D, 单位为周期
+};
+
+// 把 root 按 info 写成 BTOR2 到 out. 信号位宽推断不出, 或断言中有无法翻译的部分时抛出 std::runtime_error
+BtorStats write_btor2(const ASTNode *root, const SmtInformation &info, SmtSink &out);
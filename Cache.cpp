@@ -0,0 +1,233 @@
+#include "Cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// 键格式或同一键的输出改变时递增, 使旧条目失效.
+//   2: 优先级解析器改变了同一记号序列的结合方式
+//   3: --parametric 中常量比较的 sort 按输出的字面量取
+//   4: 只引用一次的共享子项不再输出 define-fun
+//   5: --parametric 为重复的每个偏移各设一个参数, 固定的重复不再退回共享子项
+//   6: 区间延时按 r 成立的周期链式展开, 不再为左操作数的每个结束周期各列一个窗口
+static const char CACHE_VERSION[] = "sva2smt-cache-6";
+
+// FNV-1a 128 位
+class Fnv128 {
+public:
+    void add(std::string_view data) {
+        for (unsigned char c : data) {
+            state ^= c;
+            state *= PRIME;
+        }
+    }
+    // 字段之间加分隔, 避免 "ab"+"c" 与 "a"+"bc" 相同
+    void field(std::string_view data) {
+        add(std::to_string(data.size()));
+        add(":");
+        add(data);
+    }
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string text(32, '0');
+        unsigned __int128 value = state;
+        for (size_t i = 32; i != 0; i--) {
+            text[i - 1] = digits[static_cast<unsigned>(value & 15)];
+            value >>= 4;
+        }
+        return text;
+    }
+
+private:
+    static constexpr unsigned __int128 PRIME = (static_cast<unsigned __int128>(1) << 88) + 0x13b;
+    unsigned __int128 state = (static_cast<unsigned __int128>(0x6c62272e07bb0142ULL) << 64) | 0x62b821756295c58dULL;
+};
+
+// 持有缓存目录锁文件的独占 flock
+class DirectoryLock {
+public:
+    explicit DirectoryLock(const std::string &directory) {
+        fd = open((directory + "/lock").c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd >= 0) {
+            flock(fd, LOCK_EX);
+        }
+    }
+    ~DirectoryLock() {
+        if (fd >= 0) {
+            flock(fd, LOCK_UN);
+            close(fd);
+        }
+    }
+
+private:
+    int fd;
+};
+
+static void copy_file(const std::string &from, const std::string &to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        throw std::runtime_error("cannot copy " + from + " to " + to);
+    }
+    out << in.rdbuf();
+    if (!out) {
+        throw std::runtime_error("cannot write " + to);
+    }
+}
+
+TranslationCache::TranslationCache(const std::string &directory, uint64_t max_bytes)
+    : directory(directory), max_bytes(max_bytes) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (!fs::is_directory(directory)) {
+        throw std::runtime_error("cannot create cache directory " + directory);
+    }
+}
+
+std::string TranslationCache::key(const std::vector<Token> &tokens, const SmtInformation &info) {
+    Fnv128 hash;
+    hash.field(CACHE_VERSION);
+    for (const Token &token : tokens) {
+        hash.field(std::to_string(token.type));
+        hash.field(token.value);
+    }
+    hash.field(info.ModuleName);
+    hash.field(std::to_string(info.Time));
+    hash.field(info.NeedFalse ? "needfalse" : "needtrue");
+    hash.field(info.ShareTerms ? "share" : "");
+    hash.field(info.Simplify ? "simplify" : "");
+    hash.field(info.Declare ? "declare" : "");
+    hash.field(info.Parametric ? "parametric" : "");
+    hash.field(info.Incremental ? "incremental" : "");
+    if (info.GzipLevel >= 0) {
+        hash.field("gzip" + std::to_string(info.GzipLevel));
+    }
+    for (const auto &[name, sort] : info.SignalSorts) {
+        hash.field(name);
+        hash.field(sort);
+    }
+    if (!info.PreludeFile.empty()) {
+        std::ifstream prelude(info.PreludeFile, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(prelude)), std::istreambuf_iterator<char>());
+        hash.field(text);
+    }
+    return hash.hex();
+}
+
+std::string TranslationCache::entry_path(const std::string &key) const {
+    return directory + "/" + key + ".smt2";
+}
+
+std::string TranslationCache::temporary_path() const {
+    static std::atomic<unsigned> counter{0};
+    return directory + "/tmp." + std::to_string(getpid()) + "." +
+           std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "." +
+           std::to_string(counter.fetch_add(1));
+}
+
+bool TranslationCache::fetch(const std::string &key, const std::string &output) {
+    std::string entry = entry_path(key);
+    // 条目可能正被其他进程淘汰, 任何一步失败都按未命中处理
+    if (access(entry.c_str(), R_OK) != 0) {
+        miss_count++;
+        return false;
+    }
+    unlink(output.c_str());
+    if (link(entry.c_str(), output.c_str()) != 0) {
+        try {
+            std::string temporary = output + ".tmp";
+            copy_file(entry, temporary);
+            if (rename(temporary.c_str(), output.c_str()) != 0) {
+                unlink(temporary.c_str());
+                miss_count++;
+                return false;
+            }
+        } catch (const std::runtime_error &) {
+            miss_count++;
+            return false;
+        }
+    }
+    // 以修改时间作为最近使用时间
+    utimensat(AT_FDCWD, entry.c_str(), nullptr, 0);
+    hit_count++;
+    return true;
+}
+
+void TranslationCache::store(const std::string &key, const std::string &file) {
+    std::string temporary = temporary_path();
+    copy_file(file, temporary);
+    if (rename(temporary.c_str(), entry_path(key).c_str()) != 0) {
+        unlink(temporary.c_str());
+        throw std::runtime_error("cannot store cache entry " + key);
+    }
+    evict();
+}
+
+void TranslationCache::evict() {
+    DirectoryLock lock(directory);
+    struct Entry {
+        fs::file_time_type used;
+        uint64_t size;
+        fs::path path;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto &item : fs::directory_iterator(directory, error)) {
+        if (item.path().extension() != ".smt2" || !item.is_regular_file(error)) {
+            continue;
+        }
+        uint64_t size = item.file_size(error);
+        entries.push_back(Entry{item.last_write_time(error), size, item.path()});
+        total += size;
+    }
+    if (total <= max_bytes) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+    for (const Entry &entry : entries) {
+        if (total <= max_bytes) {
+            break;
+        }
+        if (fs::remove(entry.path, error)) {
+            total -= entry.size;
+        }
+    }
+}
+
+std::pair<unsigned long long, unsigned long long> TranslationCache::commit_counters() {
+    DirectoryLock lock(directory);
+    std::string counters = directory + "/counters";
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    {
+        std::ifstream in(counters);
+        std::string name;
+        unsigned long long value;
+        while (in >> name >> value) {
+            if (name == "hits") {
+                hits = value;
+            } else if (name == "misses") {
+                misses = value;
+            }
+        }
+    }
+    hits += hit_count.exchange(0);
+    misses += miss_count.exchange(0);
+    std::string temporary = temporary_path();
+    {
+        std::ofstream out(temporary);
+        out << "hits " << hits << "\nmisses " << misses << "\n";
+    }
+    rename(temporary.c_str(), counters.c_str());
+    return {hits, misses};
+}
@@ -0,0 +1,40 @@
+//
+// 按内容寻址的翻译缓存: 键是规范化 token 流与影响输出的 SmtInformation 字段的哈希,
+// 命中时把保存的 SMT 文件硬链接 (跨文件系统时复制) 到输出路径, 不再建 AST 和展开.
+// 条目先写临时文件再 rename, 并发运行安全; 总大小超过上限时按最近使用时间淘汰.
+// 命中/未命中计数保存在缓存目录的 counters 文件中, 跨运行累计.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include <atomic>
+#include <cstdint>
+
+class TranslationCache {
+public:
+    // directory 不存在时创建, 失败时抛出 std::runtime_error
+    TranslationCache(const std::string &directory, uint64_t max_bytes);
+
+    // 32 位十六进制的键; 空白和注释不同但 token 相同的断言得到同一个键
+    static std::string key(const std::vector<Token> &tokens, const SmtInformation &info);
+
+    // 命中时把条目放到 output 并更新其使用时间
+    bool fetch(const std::string &key, const std::string &output);
+    // 把已写好的 file 保存为 key 的条目, 然后按上限淘汰
+    void store(const std::string &key, const std::string &file);
+
+    unsigned long long hits() const { return hit_count; }
+    unsigned long long misses() const { return miss_count; }
+    // 把本进程的计数累加到 counters 文件, 返回累计值
+    std::pair<unsigned long long, unsigned long long> commit_counters();
+
+private:
+    std::string entry_path(const std::string &key) const;
+    std::string temporary_path() const;
+    void evict();
+
+    std::string directory;
+    uint64_t max_bytes;
+    std::atomic<unsigned long long> hit_count{0};
+    std::atomic<unsigned long long> miss_count{0};
+};
@@ -0,0 +1,428 @@
+#include "CnfWriter.h"
+#include "Profiler.h"
+#include "SortInference.h"
+#include <algorithm>
+#include <unordered_map>
+
+static const int TRUE_LITERAL = 1;
+
+struct NodeTime {
+    const ASTNode *node;
+    unsigned time;
+    bool operator==(const NodeTime &other) const { return node == other.node && time == other.time; }
+};
+
+struct NodeTimeHash {
+    size_t operator()(const NodeTime &key) const {
+        return std::hash<const void *>()(key.node) * 31 + key.time;
+    }
+};
+
+struct LiteralsHash {
+    size_t operator()(const std::vector<int> &literals) const {
+        size_t hash = 14695981039346656037ULL;
+        for (int literal : literals) {
+            hash = (hash ^ static_cast<unsigned>(literal)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// 去掉括号后是否为位向量的值 (信号, 位选, 常量), 而不是 Bool 表达式
+static bool is_value(const ASTNode *node) {
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    switch (node->kind()) {
+        case NODE_IDENTIFIER:
+        case NODE_BIT_SELECT:
+        case NODE_RANGE_SELECT:
+        case NODE_DATA_VALUE:
+        case NODE_BIT_VALUE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Tseitin 编码器: 门和信号位都是变量, 子句先存在内存里, 最后连同 p cnf 头一起写出
+class CnfEncoder {
+public:
+    CnfEncoder(const ASTNode *root, const SmtInformation &info, SmtSink &map)
+        : info(info), map(map), sorts(infer_signal_sorts(root, info)), variables(1), clause_count(1),
+          clauses{TRUE_LITERAL, 0} {}
+
+    // node 在 time 时刻的 Bool 值
+    int literal(const ASTNode *node, unsigned time);
+    int make_and(std::vector<int> inputs);
+    int make_or(std::vector<int> inputs);
+    int new_variable() { return static_cast<int>(++variables); }
+    void add_clause(std::initializer_list<int> literals) { add_clause(literals.begin(), literals.end()); }
+    template <typename Iterator>
+    void add_clause(Iterator first, Iterator last) {
+        clauses.insert(clauses.end(), first, last);
+        clauses.push_back(0);
+        clause_count++;
+    }
+    void write(SmtSink &out) const;
+
+    SmtSink &variable_map() { return map; }
+    CnfStats stats() const { return CnfStats{variables, clause_count}; }
+
+private:
+    int make_xor(int left, int right);
+    int compute(const ASTNode *node, unsigned time);
+    int compute_delay(const DelayControl *node, unsigned time);
+    int compute_compare(const CompareExpression *node, unsigned time);
+    // 值的各位, 最低位在前
+    std::vector<int> value_bits(const ASTNode *node, unsigned time);
+    const std::vector<int> &signal_bits(const Identifier *signal, unsigned time);
+    int memo(const ASTNode *node, unsigned time) const { return literals.at(NodeTime{node, time}); }
+
+    const SmtInformation &info;
+    SmtSink &map;
+    std::map<std::string, std::string> sorts;
+    unsigned variables;
+    size_t clause_count;
+    std::vector<int> clauses;  // 以 0 结尾的子句依次排列, 第一个是单元子句 TRUE_LITERAL
+    std::unordered_map<NodeTime, int, NodeTimeHash> literals;
+    std::unordered_map<std::vector<int>, int, LiteralsHash> and_gates;
+    std::unordered_map<uint64_t, int> xor_gates;
+    std::unordered_map<uint64_t, std::vector<int>> signals;  // (符号, 时刻) -> 各位的变量
+};
+
+int CnfEncoder::make_and(std::vector<int> inputs) {
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    inputs.erase(std::remove(inputs.begin(), inputs.end(), TRUE_LITERAL), inputs.end());
+    for (int input : inputs) {
+        // 含 false 或互补的两个文字
+        if (input == -TRUE_LITERAL || std::binary_search(inputs.begin(), inputs.end(), -input)) {
+            return -TRUE_LITERAL;
+        }
+    }
+    if (inputs.empty()) {
+        return TRUE_LITERAL;
+    }
+    if (inputs.size() == 1) {
+        return inputs[0];
+    }
+    auto found = and_gates.find(inputs);
+    if (found != and_gates.end()) {
+        return found->second;
+    }
+    int gate = new_variable();
+    // gate -> 各输入, 各输入 -> gate
+    std::vector<int> converse{gate};
+    for (int input : inputs) {
+        add_clause({-gate, input});
+        converse.push_back(-input);
+    }
+    add_clause(converse.begin(), converse.end());
+    and_gates.emplace(std::move(inputs), gate);
+    return gate;
+}
+
+int CnfEncoder::make_or(std::vector<int> inputs) {
+    for (int &input : inputs) {
+        input = -input;
+    }
+    return -make_and(std::move(inputs));
+}
+
+int CnfEncoder::make_xor(int left, int right) {
+    if (std::abs(left) == TRUE_LITERAL) {
+        return left == TRUE_LITERAL ? -right : right;
+    }
+    if (std::abs(right) == TRUE_LITERAL) {
+        return right == TRUE_LITERAL ? -left : left;
+    }
+    if (left == right) {
+        return -TRUE_LITERAL;
+    }
+    if (left == -right) {
+        return TRUE_LITERAL;
+    }
+    // 取反提到外面, 只为两个正文字建门
+    bool flip = (left < 0) != (right < 0);
+    int a = std::min(std::abs(left), std::abs(right));
+    int b = std::max(std::abs(left), std::abs(right));
+    uint64_t key = (static_cast<uint64_t>(a) << 32) | static_cast<unsigned>(b);
+    auto found = xor_gates.find(key);
+    int gate;
+    if (found != xor_gates.end()) {
+        gate = found->second;
+    } else {
+        gate = new_variable();
+        add_clause({-gate, a, b});
+        add_clause({-gate, -a, -b});
+        add_clause({gate, -a, b});
+        add_clause({gate, a, -b});
+        xor_gates.emplace(key, gate);
+    }
+    return flip ? -gate : gate;
+}
+
+const std::vector<int> &CnfEncoder::signal_bits(const Identifier *signal, unsigned time) {
+    uint64_t key = (static_cast<uint64_t>(signal->get_symbol()) << 32) | time;
+    auto found = signals.find(key);
+    if (found != signals.end()) {
+        return found->second;
+    }
+    auto sort = sorts.find(signal->get_name());
+    unsigned width = sort == sorts.end() ? 0 : sort_width(sort->second);
+    if (width == 0) {
+        throw std::runtime_error("cannot infer the width of " + signal->get_name() + ", give it with --sort");
+    }
+    std::vector<int> &bits = signals[key];
+    std::string name = GET_DECLARE_NAME(info, signal->get_name(), time);
+    for (unsigned bit = 0; bit < width; bit++) {
+        bits.push_back(new_variable());
+        map << std::to_string(bits.back()) << " " << name;
+        if (sort->second != "Bool") {
+            map << "[" << std::to_string(bit) << "]";
+        }
+        map << "\n";
+    }
+    return bits;
+}
+
+std::vector<int> CnfEncoder::value_bits(const ASTNode *node, unsigned time) {
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    switch (node->kind()) {
+        case NODE_IDENTIFIER:
+            return signal_bits(static_cast<const Identifier *>(node), time);
+        case NODE_BIT_SELECT: {
+            auto select = static_cast<const BitSelect *>(node);
+            const std::vector<int> &bits = signal_bits(select->get_variable(), time);
+            if (static_cast<size_t>(select->get_bit()) >= bits.size()) {
+                throw std::runtime_error("bit select out of range: " + select->to_string());
+            }
+            return {bits[select->get_bit()]};
+        }
+        case NODE_RANGE_SELECT: {
+            auto select = static_cast<const RangeSelect *>(node);
+            const std::vector<int> &bits = signal_bits(select->get_variable(), time);
+            if (select->get_lsb() > select->get_msb() || static_cast<size_t>(select->get_msb()) >= bits.size()) {
+                throw std::runtime_error("range select out of range: " + select->to_string());
+            }
+            return std::vector<int>(bits.begin() + select->get_lsb(), bits.begin() + select->get_msb() + 1);
+        }
+        case NODE_DATA_VALUE: {
+            const std::string &data = static_cast<const DataValue *>(node)->get_data();
+            std::vector<int> bits;
+            for (size_t i = data.size(); i != 0; i--) {
+                bits.push_back(data[i - 1] == '1' ? TRUE_LITERAL : -TRUE_LITERAL);
+            }
+            return bits;
+        }
+        case NODE_BIT_VALUE: {
+            // 不带位宽的整数, 取能表示它的最少位数
+            unsigned value = static_cast<unsigned>(static_cast<const BitValue *>(node)->get_value());
+            std::vector<int> bits;
+            do {
+                bits.push_back(value & 1 ? TRUE_LITERAL : -TRUE_LITERAL);
+                value >>= 1;
+            } while (value != 0);
+            return bits;
+        }
+        default:
+            // Bool 表达式作为 1 位的值
+            return {memo(node, time)};
+    }
+}
+
+int CnfEncoder::compute_compare(const CompareExpression *node, unsigned time) {
+    std::vector<int> left = value_bits(node->child(0), time);
+    std::vector<int> right = value_bits(node->child(1), time);
+    // 位宽不同时高位补 0
+    size_t width = std::max(left.size(), right.size());
+    left.resize(width, -TRUE_LITERAL);
+    right.resize(width, -TRUE_LITERAL);
+
+    std::vector<int> differ;
+    for (size_t i = 0; i < width; i++) {
+        differ.push_back(make_xor(left[i], right[i]));
+    }
+    // a < b: 从最低位起, less = (!a_i && b_i) || (a_i == b_i && less)
+    auto less_than = [&](const std::vector<int> &a, const std::vector<int> &b) {
+        int less = -TRUE_LITERAL;
+        for (size_t i = 0; i < width; i++) {
+            less = make_or({make_and({-a[i], b[i]}), make_and({-differ[i], less})});
+        }
+        return less;
+    };
+    switch (node->get_compare_type()) {
+        case CompareExpression::EQUAL:
+            return -make_or(differ);
+        case CompareExpression::NEQUAL:
+            return make_or(differ);
+        case CompareExpression::LESS:
+            return less_than(left, right);
+        case CompareExpression::GREATER:
+            return less_than(right, left);
+        case CompareExpression::LEQUAL:
+            return -less_than(right, left);
+        default:
+            return -less_than(left, right);
+    }
+}
+
+// 与 DelayControl::emit_range 的展开一致: 首个窗口之后每环一个 b 和一个 r, 规模与区间宽度成线性
+int CnfEncoder::compute_delay(const DelayControl *node, unsigned time) {
+    const unsigned horizon = info.Time;
+    const Repetition *repetition = node->left_repetition();
+    const unsigned first = repetition ? repetition->get_min() : 1;
+    const unsigned links = repetition ? repetition->get_max(horizon) - first : 0;
+    const unsigned high = node->get_max_delay(horizon);
+    const ASTNode *right = node->child(1);
+
+    // 从最后一环向前: L_i = (and b@(first+i-1) (or r@(first-1+high+i) L_{i+1}))
+    int rest = -TRUE_LITERAL;
+    for (unsigned i = links; i != 0; i--) {
+        std::vector<int> ends{memo(right, time + (first - 1 + high + i) * TIME_CLOCK)};
+        if (i != links) {
+            ends.push_back(rest);
+        }
+        rest = make_and({memo(repetition->get_operand(), time + (first + i - 1) * TIME_CLOCK), make_or(ends)});
+    }
+    std::vector<int> window;
+    for (unsigned k = node->get_delay(); k <= high; k++) {
+        window.push_back(memo(right, time + (first - 1 + k) * TIME_CLOCK));
+    }
+    if (links != 0) {
+        window.push_back(rest);
+    }
+    int result = make_or(window);
+    return make_and({memo(node->child(0), time), info.NeedFalse ? -result : result});
+}
+
+int CnfEncoder::compute(const ASTNode *node, unsigned time) {
+    if (is_value(node)) {
+        // Bool 上下文中的值 (可能带括号): 非 0 为真
+        return make_or(value_bits(node, time));
+    }
+    switch (node->kind()) {
+        case NODE_PAREN:
+            return memo(node->child(0), time);
+        case NODE_BOOL_VALUE:
+            return static_cast<const BoolValue *>(node)->get_value() ? TRUE_LITERAL : -TRUE_LITERAL;
+        case NODE_LOGIC: {
+            std::vector<int> inputs;
+            for (size_t i = 0; i < node->child_count(); i++) {
+                inputs.push_back(memo(node->child(i), time));
+            }
+            return static_cast<const LogicAndOrOperation *>(node)->get_op() == OP_AND ? make_and(inputs)
+                                                                                      : make_or(inputs);
+        }
+        case NODE_DELAY:
+            return compute_delay(static_cast<const DelayControl *>(node), time);
+        case NODE_OVERLAP: {
+            int right = memo(node->child(1), node->child_time(1, time));
+            return make_and({memo(node->child(0), time), info.NeedFalse ? -right : right});
+        }
+        case NODE_REPEAT: {
+            auto repetition = static_cast<const Repetition *>(node);
+            std::vector<int> inputs;
+            for (unsigned i = 0; i < repetition->get_min(); i++) {
+                inputs.push_back(memo(repetition->get_operand(), time + i * TIME_CLOCK));
+            }
+            return make_and(inputs);
+        }
+        case NODE_COMPARE:
+            return compute_compare(static_cast<const CompareExpression *>(node), time);
+        default:
+            return make_or(value_bits(node, time));
+    }
+}
+
+// 后序遍历 (节点, 时刻), 用显式栈代替递归; 比较的位向量操作数在比较节点里直接展开
+int CnfEncoder::literal(const ASTNode *root, unsigned time) {
+    struct Frame {
+        const ASTNode *node;
+        unsigned time;
+        bool visited;
+    };
+    std::vector<Frame> work{{root, time, false}};
+    while (!work.empty()) {
+        Frame frame = work.back();
+        work.pop_back();
+        if (literals.count(NodeTime{frame.node, frame.time})) {
+            continue;
+        }
+        if (frame.visited) {
+            literals.emplace(NodeTime{frame.node, frame.time}, compute(frame.node, frame.time));
+            continue;
+        }
+        work.push_back({frame.node, frame.time, true});
+        if (is_value(frame.node)) {
+            continue;
+        }
+        for (size_t i = 0; i < frame.node->child_count(); i++) {
+            const ASTNode *child = frame.node->child(i);
+            if (frame.node->kind() == NODE_COMPARE && is_value(child)) {
+                continue;
+            }
+            unsigned first = frame.node->child_time(i, frame.time);
+            for (unsigned k = 0, span = frame.node->child_span(i, info.Time); k < span; k++) {
+                work.push_back({child, first + k * TIME_CLOCK, false});
+            }
+        }
+    }
+    return memo(root, time);
+}
+
+static void write_literal(SmtSink &out, int literal) {
+    if (literal < 0) {
+        out << "-";
+    }
+    out << static_cast<unsigned long long>(std::abs(literal));
+}
+
+void CnfEncoder::write(SmtSink &out) const {
+    out << "p cnf " << variables << " " << clause_count << "\n";
+    bool start = true;
+    for (int literal : clauses) {
+        if (!start) {
+            out << " ";
+        }
+        write_literal(out, literal);
+        start = literal == 0;
+        if (start) {
+            out << "\n";
+        }
+    }
+}
+
+CnfStats write_cnf(const ASTNode *root, const SmtInformation &info, SmtSink &out, SmtSink &map) {
+    // 没有步时 Assert_i 的析取是空子句, 整个公式无声地不可满足
+    if (info.Time < 2) {
+        throw std::runtime_error("--format cnf needs time >= 2, no step would be checked");
+    }
+    const bool negate = info.NegateRoot >= 0 ? info.NegateRoot != 0 : info.NeedFalse && !root->has_overlap();
+    CnfEncoder encoder(root, info, map);
+    std::vector<int> asserts;
+    for (unsigned step = 1; step < info.Time; step+=2) {
+        ProfileScope scope("step", step);
+        int property = encoder.literal(root, step);
+        // Assert_i 是独立的变量, 便于从模型中读出哪一步出错
+        int variable = encoder.new_variable();
+        int value = negate ? -property : property;
+        encoder.add_clause({-variable, value});
+        encoder.add_clause({variable, -value});
+        encoder.variable_map() << std::to_string(variable) << " Assert_" << std::to_string(step) << "\n";
+        asserts.push_back(variable);
+    }
+    encoder.add_clause(asserts.begin(), asserts.end());
+    {
+        ProfileScope scope("write_cnf");
+        out << "c SVA2SMT " << info.ModuleName << " time " << info.Time << "\n";
+        encoder.write(out);
+    }
+    CnfStats stats = encoder.stats();
+    profile_count("cnf_variables", stats.variables);
+    profile_count("cnf_clauses", stats.clauses);
+    return stats;
+}
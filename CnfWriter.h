@@ -0,0 +1,25 @@
+//
+// 位级后端: 把展开后的断言直接 bit-blast 成 DIMACS CNF, 交给普通的 SAT 求解器, 省去 SMT 求解器的
+// 解析和 bit-blast. 语义与 write_smt_lib2 相同: 每个奇数步一个 Assert_i 变量, 最后一个子句为它们的析取.
+//
+// 信号的每一位是一个变量, 位宽取自 infer_signal_sorts. 其余变量是 Tseitin 门 (n 元 and 与二元 xor),
+// 相同输入的门只建一次 (结构哈希), 常量在建门时直接折叠. 变量 1 恒为真.
+//
+// 变量表每行一项, 用于把 SAT 求解器的模型解码回信号:
+//   <变量> testbench.<module>_instance.<signal>_<time>_1[<bit>]   位向量信号的一位, bit 0 为最低位
+//   <变量> testbench.<module>_instance.<signal>_<time>_1          Bool 信号
+//   <变量> Assert_<step>
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include "SmtEmitter.h"
+
+struct CnfStats {
+    unsigned variables = 0;
+    size_t clauses = 0;
+};
+
+// 把 root 按 info 展开写成 DIMACS CNF 到 out, 变量表写到 map. info.Time < 2 (没有可检查的步),
+// 信号位宽推断不出, 或断言中有无法 bit-blast 的部分时抛出 std::runtime_error
+CnfStats write_cnf(const ASTNode *root, const SmtInformation &info, SmtSink &out, SmtSink &map);
@@ -0,0 +1,214 @@
+#include "FileWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// O_DIRECT 要求缓冲区地址, 长度和文件偏移都按块对齐, 4096 覆盖常见的块大小
+static const size_t ALIGNMENT = 4096;
+
+AsyncFileSink::AsyncFileSink(const std::string &file_name, bool direct, size_t buffer_size, unsigned buffer_count)
+    : file_name(file_name), direct(direct),
+      buffer_size((std::max<size_t>(buffer_size, ALIGNMENT) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT) {
+    for (unsigned i = 0; i < std::max(buffer_count, 2u); i++) {
+        char *data = static_cast<char *>(std::aligned_alloc(ALIGNMENT, this->buffer_size));
+        if (!data) {
+            for (char *allocated : storage) {
+                std::free(allocated);
+            }
+            throw std::bad_alloc();
+        }
+        storage.push_back(data);
+        free_buffers.push_back(data);
+    }
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    fd = ::open(file_name.c_str(), flags | (direct ? O_DIRECT : 0), 0644);
+    if (fd < 0 && direct && errno == EINVAL) {
+        // tmpfs 等不支持 O_DIRECT
+        this->direct = false;
+        fd = ::open(file_name.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        std::string reason = strerror(errno);
+        for (char *data : storage) {
+            std::free(data);
+        }
+        throw std::runtime_error("cannot open " + file_name + ": " + reason);
+    }
+    current = Buffer{free_buffers.back(), 0};
+    free_buffers.pop_back();
+    opened = std::chrono::steady_clock::now();
+    writer = std::thread([this] { run(); });
+}
+
+AsyncFileSink::~AsyncFileSink() {
+    try {
+        close();
+    } catch (const std::runtime_error &) {
+        // 析构时无法报告, 需要知道结果的调用方应显式调用 close
+    }
+    for (char *data : storage) {
+        std::free(data);
+    }
+}
+
+void AsyncFileSink::write(const char *data, size_t size) {
+    written += size;
+    while (size != 0) {
+        size_t chunk = std::min(size, buffer_size - current.used);
+        memcpy(current.data + current.used, data, chunk);
+        current.used += chunk;
+        data += chunk;
+        size -= chunk;
+        if (current.used == buffer_size) {
+            submit_current();
+        }
+    }
+}
+
+// 把 current 放入待写队列, 换一块空闲缓冲区; I/O 线程落后时在这里等待
+void AsyncFileSink::submit_current() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.push_back(current);
+    filled.notify_one();
+    drained.wait(lock, [this] { return !free_buffers.empty(); });
+    current = Buffer{free_buffers.back(), 0};
+    free_buffers.pop_back();
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+void AsyncFileSink::flush() {
+    if (current.used != 0) {
+        submit_current();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return pending.empty() && !writing; });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+void AsyncFileSink::close() {
+    if (fd < 0) {
+        return;
+    }
+    std::string failure;
+    try {
+        flush();
+    } catch (const std::runtime_error &flush_error) {
+        failure = flush_error.what();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    filled.notify_all();
+    writer.join();
+    if (::close(fd) != 0 && failure.empty()) {
+        failure = "cannot close " + file_name + ": " + strerror(errno);
+    }
+    fd = -1;
+    closed = std::chrono::steady_clock::now();
+    if (!failure.empty()) {
+        throw std::runtime_error(failure);
+    }
+}
+
+double AsyncFileSink::seconds() const {
+    auto end = fd >= 0 ? std::chrono::steady_clock::now() : closed;
+    return std::chrono::duration<double>(end - opened).count();
+}
+
+double AsyncFileSink::bandwidth() const {
+    double elapsed = seconds();
+    return elapsed > 0 ? written / 1e6 / elapsed : 0;
+}
+
+// I/O 线程: 每次取走队列中所有写满的缓冲区, 写完后放回空闲列表
+void AsyncFileSink::run() {
+    std::vector<Buffer> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            filled.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                return;
+            }
+            batch.assign(pending.begin(), pending.end());
+            pending.clear();
+            writing = true;
+        }
+        std::string failure;
+        try {
+            write_batch(batch);
+        } catch (const std::runtime_error &write_error) {
+            failure = write_error.what();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const Buffer &buffer : batch) {
+                free_buffers.push_back(buffer.data);
+            }
+            writing = false;
+            if (error.empty()) {
+                error = failure;
+            }
+        }
+        drained.notify_all();
+    }
+}
+
+void AsyncFileSink::write_batch(std::vector<Buffer> &batch) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error.empty()) {
+            return;  // 已经失败, 丢弃剩余输出
+        }
+    }
+    std::vector<iovec> vectors;
+    for (const Buffer &buffer : batch) {
+        if (buffer.used % ALIGNMENT != 0 && direct) {
+            // 最后一块 (或 flush 交出的一块) 长度不对齐, 此后改为普通写
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            direct = false;
+        }
+        vectors.push_back(iovec{buffer.data, buffer.used});
+    }
+    size_t first = 0;
+    while (first < vectors.size()) {
+        int count = static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX));
+        ssize_t done = writev(fd, vectors.data() + first, count);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EINVAL && direct) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+                direct = false;
+                continue;
+            }
+            throw std::runtime_error("cannot write " + file_name + ": " + strerror(errno));
+        }
+        // 部分写入: 跳过已写完的向量, 调整第一个未写完的
+        size_t left = static_cast<size_t>(done);
+        while (first < vectors.size() && left >= vectors[first].iov_len) {
+            left -= vectors[first].iov_len;
+            first++;
+        }
+        if (left != 0) {
+            vectors[first].iov_base = static_cast<char *>(vectors[first].iov_base) + left;
+            vectors[first].iov_len -= left;
+            if (direct) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+                direct = false;
+            }
+        }
+    }
+}
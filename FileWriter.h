@@ -0,0 +1,68 @@
+//
+// 大文件输出: 渲染线程把文本写进一组按页对齐的大缓冲区, 写满的缓冲区交给后台 I/O 线程,
+// 后者把连续的几块用一次 writev 写出, 同时渲染线程继续填下一块. 可选 O_DIRECT 绕过页缓存.
+//
+#pragma once
+
+#include "SmtEmitter.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AsyncFileSink : public SmtSink {
+public:
+    // 创建 (截断) file_name, 无法打开时抛出 std::runtime_error.
+    // direct 为 true 时尝试 O_DIRECT, 文件系统不支持时退回普通写
+    explicit AsyncFileSink(const std::string &file_name, bool direct = false,
+                           size_t buffer_size = 4 << 20, unsigned buffer_count = 4);
+    AsyncFileSink(const AsyncFileSink &) = delete;
+    AsyncFileSink &operator=(const AsyncFileSink &) = delete;
+    ~AsyncFileSink() override;
+
+    // 后台写失败时, 之后的 write/flush/close 抛出 std::runtime_error
+    void write(const char *data, size_t size) override;
+    // 交出当前缓冲区并等待全部写入文件
+    void flush() override;
+    // flush 后关闭文件, 之后不能再写
+    void close();
+
+    unsigned long long bytes() const { return written; }
+    double seconds() const;
+    // 从打开到关闭 (或当前) 的平均写出速度, MB/s
+    double bandwidth() const;
+
+private:
+    struct Buffer {
+        char *data;
+        size_t used;
+    };
+
+    void submit_current();
+    void run();
+    void write_batch(std::vector<Buffer> &batch);
+
+    std::string file_name;
+    int fd = -1;
+    bool direct = false;
+    size_t buffer_size;
+    std::vector<char *> storage;
+    Buffer current{nullptr, 0};
+
+    std::mutex mutex;
+    std::condition_variable filled;   // 有待写的缓冲区或要求退出
+    std::condition_variable drained;  // 有空闲缓冲区或待写队列写完
+    std::deque<Buffer> pending;
+    std::vector<char *> free_buffers;
+    bool writing = false;
+    bool stopping = false;
+    std::string error;
+    std::thread writer;
+
+    unsigned long long written = 0;
+    std::chrono::steady_clock::time_point opened;
+    std::chrono::steady_clock::time_point closed;
+};
@@ -0,0 +1,159 @@
+#include "GzipWriter.h"
+#include <algorithm>
+#include <stdexcept>
+#include <zlib.h>
+
+// 渲染线程最多领先压缩线程的块数
+static const size_t MAX_PENDING = 2;
+
+struct GzipSink::Stream {
+    z_stream z{};
+};
+
+GzipSink::GzipSink(SmtSink &target, int level, bool threaded, size_t block_size)
+    : target(target), stream(new Stream), output(1 << 18), block_size(block_size), threaded(threaded) {
+    // windowBits 加 16 写 gzip 头和尾而不是 zlib 格式
+    if (deflateInit2(&stream->z, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("cannot initialize gzip compression at level " + std::to_string(level));
+    }
+    current.reserve(block_size);
+    if (threaded) {
+        compressor = std::thread([this] { run(); });
+    }
+}
+
+GzipSink::~GzipSink() {
+    try {
+        finish();
+    } catch (const std::runtime_error &) {
+        // 析构时无法报告, 需要知道结果的调用方应显式调用 finish
+    }
+    if (compressor.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        compressor.join();
+    }
+    deflateEnd(&stream->z);
+}
+
+void GzipSink::write(const char *data, size_t size) {
+    input_bytes += size;
+    while (size != 0) {
+        size_t chunk = std::min(size, block_size - current.size());
+        current.insert(current.end(), data, data + chunk);
+        data += chunk;
+        size -= chunk;
+        if (current.size() == block_size) {
+            submit(Z_NO_FLUSH);
+        }
+    }
+}
+
+void GzipSink::flush() {
+    submit(Z_SYNC_FLUSH);
+    wait_idle();
+    target.flush();
+}
+
+void GzipSink::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    submit(Z_FINISH);
+    wait_idle();
+}
+
+// 把 current 作为一块交出: 不用线程时直接压缩, 否则放入队列, 队列满时等待
+void GzipSink::submit(int mode) {
+    if (!threaded) {
+        compress(current, mode);
+        current.clear();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return pending.size() < MAX_PENDING; });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    pending.push_back(Block{std::move(current), mode});
+    queued.notify_one();
+    if (spare.empty()) {
+        current = std::vector<char>();
+        current.reserve(block_size);
+    } else {
+        current = std::move(spare.back());
+        spare.pop_back();
+    }
+}
+
+void GzipSink::wait_idle() {
+    if (!threaded) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return pending.empty() && !compressing; });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+void GzipSink::compress(const std::vector<char> &data, int mode) {
+    z_stream &z = stream->z;
+    z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    z.avail_in = static_cast<uInt>(data.size());
+    int status;
+    do {
+        z.next_out = reinterpret_cast<Bytef *>(output.data());
+        z.avail_out = static_cast<uInt>(output.size());
+        status = deflate(&z, mode);
+        if (status == Z_STREAM_ERROR) {
+            throw std::runtime_error("gzip compression failed");
+        }
+        size_t produced = output.size() - z.avail_out;
+        target.write(output.data(), produced);
+        output_bytes += produced;
+    } while (z.avail_out == 0 && status != Z_STREAM_END);
+}
+
+// 压缩线程: 按提交顺序压缩各块并写入 target
+void GzipSink::run() {
+    for (;;) {
+        Block block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                return;
+            }
+            block = std::move(pending.front());
+            pending.pop_front();
+            compressing = true;
+        }
+        std::string failure;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failure = error;
+        }
+        if (failure.empty()) {
+            try {
+                compress(block.data, block.mode);
+            } catch (const std::runtime_error &compress_error) {
+                failure = compress_error.what();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            block.data.clear();
+            spare.push_back(std::move(block.data));
+            compressing = false;
+            if (error.empty()) {
+                error = failure;
+            }
+        }
+        drained.notify_all();
+    }
+}
@@ -0,0 +1,67 @@
+//
+// 流式 gzip 输出: 文本按块交给 zlib 的 deflate, 压缩结果写到另一个 sink (通常是 AsyncFileSink).
+// 结果是标准的 gzip 文件, 求解器可以经管道读取, 例如 zcat out.smt2.gz | z3 -in.
+// 可选在单独的线程上压缩, 与渲染重叠; 输出文件的写出本身由 AsyncFileSink 的 I/O 线程完成.
+//
+#pragma once
+
+#include "SmtEmitter.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GzipSink : public SmtSink {
+public:
+    // level 为 zlib 的压缩级别 0-9, threaded 时 deflate 在单独的线程上执行.
+    // 在压缩线程上使用 target 期间调用方不能再直接写 target
+    GzipSink(SmtSink &target, int level, bool threaded = false, size_t block_size = 1 << 20);
+    GzipSink(const GzipSink &) = delete;
+    GzipSink &operator=(const GzipSink &) = delete;
+    ~GzipSink() override;
+
+    // 压缩或写 target 失败时, 之后的 write/flush/finish 抛出 std::runtime_error
+    void write(const char *data, size_t size) override;
+    // 到此为止的内容可以完整解压 (Z_SYNC_FLUSH), 并 flush target
+    void flush() override;
+    // 写出 gzip 尾部, 之后不能再写; 不关闭 target
+    void finish();
+
+    unsigned long long bytes_in() const { return input_bytes; }
+    unsigned long long bytes_out() const { return output_bytes; }
+
+private:
+    struct Block {
+        std::vector<char> data;
+        int mode;  // Z_NO_FLUSH, Z_SYNC_FLUSH 或 Z_FINISH
+    };
+    struct Stream;
+
+    void submit(int mode);
+    void wait_idle();
+    void compress(const std::vector<char> &data, int mode);
+    void run();
+
+    SmtSink &target;
+    std::unique_ptr<Stream> stream;
+    std::vector<char> output;
+    size_t block_size;
+    std::vector<char> current;
+    bool finished = false;
+    unsigned long long input_bytes = 0;
+    unsigned long long output_bytes = 0;
+
+    bool threaded;
+    std::mutex mutex;
+    std::condition_variable queued;   // 有待压缩的块或要求退出
+    std::condition_variable drained;  // 队列有空位或全部压缩完
+    std::deque<Block> pending;
+    std::vector<std::vector<char>> spare;  // 压缩完的块, 保留容量供重用
+    bool compressing = false;
+    bool stopping = false;
+    std::string error;
+    std::thread compressor;
+};
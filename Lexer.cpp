@@ -0,0 +1,140 @@
+//
+// 单遍词法分析器: 按首字符分派, 每个字符只看一次, token 直接指向输入缓冲区.
+// 跨行断言中的 // 与 /* */ 注释被整体跳过, 其他无法识别的字符与旧的正则版本一样被跳过.
+//
+#include "SVA2SMT.h"
+
+static bool is_ident_head(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_ident_body(char c) {
+    return is_ident_head(c) || is_digit(c);
+}
+
+// 匹配 [01]+ 或 [xz]+, 返回匹配长度
+static size_t scan_set(std::string_view input, size_t pos, const char *set) {
+    size_t end = pos;
+    while (end < input.size() && (input[end] == set[0] || input[end] == set[1])) {
+        end++;
+    }
+    return end - pos;
+}
+
+// ##[...] 或 [*...] 到 ']' 为止的长度, 内容由解析器检查; 没有 ']' 时取到末尾
+static size_t bracket_length(std::string_view input, size_t pos) {
+    size_t close = input.find(']', pos);
+    return close == std::string_view::npos ? input.size() - pos : close + 1 - pos;
+}
+
+std::vector<Token> tokenize(std::string_view input) {
+    std::vector<Token> tokens;
+    size_t pos = 0;
+    const size_t size = input.size();
+
+    auto emit = [&](TokenType type, size_t length) {
+        tokens.push_back(Token{type, input.substr(pos, length), pos});
+        pos += length;
+    };
+    auto next_is = [&](size_t ahead, char c) {
+        return pos + ahead < size && input[pos + ahead] == c;
+    };
+
+    while (pos < size) {
+        const char c = input[pos];
+        if (is_ident_head(c)) {
+            size_t end = pos + 1;
+            while (end < size && is_ident_body(input[end])) {
+                end++;
+            }
+            emit(TokenType::IDENTIFIER, end - pos);
+        } else if (is_digit(c)) {
+            // 4'b0101 / 4'bxxxx / 纯数字
+            size_t end = pos + 1;
+            while (end < size && is_digit(input[end])) {
+                end++;
+            }
+            if (end + 1 < size && input[end] == '\'' && (input[end + 1] == 'b' || input[end + 1] == 'B')) {
+                size_t bits = scan_set(input, end + 2, "01");
+                if (bits != 0) {
+                    emit(TokenType::DATA_B, end + 2 + bits - pos);
+                    continue;
+                }
+                bits = scan_set(input, end + 2, "xz");
+                if (bits != 0) {
+                    emit(TokenType::XZ_VALUE, end + 2 + bits - pos);
+                    continue;
+                }
+            }
+            emit(TokenType::BIT_SELECT, end - pos);
+        } else {
+            switch (c) {
+                case '&':
+                    if (next_is(1, '&')) { emit(TokenType::AND, 2); continue; }
+                    break;
+                case '|':
+                    if (next_is(1, '|')) { emit(TokenType::OR, 2); continue; }
+                    if (next_is(1, '-') && next_is(2, '>')) { emit(TokenType::OVERLAP, 3); continue; }
+                    if (next_is(1, '=') && next_is(2, '>')) { emit(TokenType::NOT_OVERLAP, 3); continue; }
+                    break;
+                case '#':
+                    if (next_is(1, '#') && next_is(2, '[')) {
+                        emit(TokenType::DELAY_RANGE, bracket_length(input, pos));
+                        continue;
+                    }
+                    if (next_is(1, '#') && pos + 2 < size && is_digit(input[pos + 2])) {
+                        size_t end = pos + 3;
+                        while (end < size && is_digit(input[end])) {
+                            end++;
+                        }
+                        emit(TokenType::DELAY_CONTROL, end - pos);
+                        continue;
+                    }
+                    break;
+                case '=':
+                    if (next_is(1, '=')) { emit(TokenType::EQUALS, 2); continue; }
+                    break;
+                case '!':
+                    if (next_is(1, '=')) { emit(TokenType::NOT_EQUALS, 2); continue; }
+                    break;
+                case '<':
+                    if (next_is(1, '=')) { emit(TokenType::LESS_EQUALS, 2); } else { emit(TokenType::LESS, 1); }
+                    continue;
+                case '>':
+                    if (next_is(1, '=')) { emit(TokenType::GREATER_EQUALS, 2); } else { emit(TokenType::GREATER, 1); }
+                    continue;
+                case '(': emit(TokenType::LPAREN, 1); continue;
+                case ')': emit(TokenType::RPAREN, 1); continue;
+                case ':': emit(TokenType::COLON, 1); continue;
+                case '[':
+                    if (next_is(1, '*')) {
+                        emit(TokenType::REPETITION, bracket_length(input, pos));
+                    } else {
+                        emit(TokenType::LBRACKET, 1);
+                    }
+                    continue;
+                case ']': emit(TokenType::RBRACKET, 1); continue;
+                case '/':
+                    if (next_is(1, '/')) {
+                        size_t end = input.find('\n', pos + 2);
+                        pos = end == std::string_view::npos ? size : end;
+                        continue;
+                    }
+                    if (next_is(1, '*')) {
+                        size_t end = input.find("*/", pos + 2);
+                        pos = end == std::string_view::npos ? size : end + 2;
+                        continue;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            pos++;
+        }
+    }
+    return tokens;
+}
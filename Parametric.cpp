@@ -0,0 +1,132 @@
+#include "Parametric.h"
+#include "SortInference.h"
+
+// 参数叶子换成参数名, 其余照常展开
+class ParameterEmitter : public SmtEmitter {
+public:
+    ParameterEmitter(SmtSink &sink, const SmtInformation &info,
+                     const std::unordered_map<ParametricProperty::Occurrence, size_t,
+                                              ParametricProperty::OccurrenceHash> &parameter_of,
+                     const std::vector<std::string> &names)
+        : SmtEmitter(sink, info), parameter_of(parameter_of), names(names) {}
+
+protected:
+    bool substitute(const ASTNode *node, unsigned time) override {
+        auto it = parameter_of.find({node, time});
+        if (it == parameter_of.end()) {
+            return false;
+        }
+        write(names[it->second]);
+        return true;
+    }
+
+private:
+    const std::unordered_map<ParametricProperty::Occurrence, size_t, ParametricProperty::OccurrenceHash> &parameter_of;
+    const std::vector<std::string> &names;
+};
+
+void ParametricProperty::add_parameter(const ASTNode *leaf, unsigned offset, const std::string &sort) {
+    std::string base = leaf->to_string() + "@" + std::to_string(offset);
+    auto inserted = parameter_by_key.emplace(base + ":" + sort, parameters.size());
+    if (inserted.second) {
+        // 同一信号在同一时刻以不同 sort 出现时加序号区分
+        unsigned uses = name_uses[base]++;
+        std::string name = "|" + base + (uses == 0 ? "" : "#" + std::to_string(uses)) + "|";
+        parameters.push_back(Parameter{leaf, offset, name, sort});
+    }
+    parameter_of[{leaf, offset}] = inserted.first->second;
+}
+
+ParametricProperty::ParametricProperty(const ASTNode *root, const SmtInformation &info) : root(root), info(info) {
+    struct Frame {
+        const ASTNode *node;
+        unsigned offset;
+        std::string sort;  // 上下文要求的 sort, "Bool" 或位向量, 空表示未知
+    };
+    std::vector<Frame> work{{root, 0, "Bool"}};
+    while (!work.empty()) {
+        Frame frame = work.back();
+        work.pop_back();
+        const ASTNode *node = frame.node;
+        switch (node->kind()) {
+            case NODE_PAREN:
+                work.push_back({node->child(0), frame.offset, frame.sort});
+                break;
+            case NODE_LOGIC:
+            case NODE_DELAY:
+            case NODE_OVERLAP:
+                for (size_t i = node->child_count(); i != 0; i--) {
+                    work.push_back({node->child(i - 1), node->child_time(i - 1, frame.offset), "Bool"});
+                }
+                break;
+            case NODE_REPEAT: {
+                // 与 Repetition::emit_smt_lib2 一致, 第 i 次重复在 offset 之后 i 个周期
+                auto repetition = static_cast<const Repetition *>(node);
+                for (unsigned i = repetition->get_min(); i != 0; i--) {
+                    work.push_back({repetition->get_operand(), frame.offset + (i - 1) * TIME_CLOCK, "Bool"});
+                }
+                break;
+            }
+            case NODE_IDENTIFIER: {
+                std::string sort = value_sort(node, info);
+                add_parameter(node, frame.offset, sort.empty() ? frame.sort : sort);
+                break;
+            }
+            case NODE_BIT_SELECT:
+            case NODE_RANGE_SELECT: {
+                auto variable = node->child(0);
+                if (!value_sort(variable, info).empty()) {
+                    add_parameter(variable, frame.offset, value_sort(variable, info));
+                } else {
+                    add_parameter(node, frame.offset, value_sort(node, info));
+                }
+                break;
+            }
+            case NODE_COMPARE: {
+                std::string sort = value_sort(node->child(0), info);
+                if (sort.empty()) {
+                    sort = value_sort(node->child(1), info);
+                }
+                if (sort.empty()) {
+                    add_parameter(node, frame.offset, "Bool");
+                } else {
+                    work.push_back({node->child(1), frame.offset, sort});
+                    work.push_back({node->child(0), frame.offset, sort});
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void ParametricProperty::define(SmtSink &out) const {
+    out << "(define-fun Property (";
+    for (size_t i = 0; i < parameters.size(); i++) {
+        out << (i == 0 ? "(" : " (") << parameters[i].name << " " << parameters[i].sort << ")";
+    }
+    out << ") Bool ";
+    std::vector<std::string> names;
+    for (const Parameter &parameter : parameters) {
+        names.push_back(parameter.name);
+    }
+    ParameterEmitter emitter(out, info, parameter_of, names);
+    auto it = parameter_of.find({root, 0});
+    if (it != parameter_of.end()) {
+        out << names[it->second];
+    } else {
+        emitter.emit(root, 0);
+    }
+    out << ")\n";
+}
+
+void ParametricProperty::apply(unsigned step, SmtSink &out) const {
+    SmtEmitter emitter(out, info);
+    out << "(Property";
+    for (const Parameter &parameter : parameters) {
+        out << " ";
+        emitter.emit(parameter.leaf, step + parameter.offset);
+    }
+    out << ")";
+}
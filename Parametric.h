@@ -0,0 +1,56 @@
+//
+// 时间参数化输出: 性质体只输出一次
+//   (define-fun Property ((|a@0| Bool) (|b[3]@2| (_ BitVec 1)) ...) Bool body)
+// 每个 Assert_i 只是 Property 对第 i 步各信号的一次应用, 输出规模为 O(Time + |property|).
+//
+// 参数是各相对时刻上用到的信号. 信号的 sort 取自 SmtInformation::SignalSorts, 否则按上下文推断:
+// Bool 运算的操作数为 Bool, 与常量/位选比较的信号取对方的位宽. 推断不出时退而以包含它的
+// 位选 (sort 为其位宽) 或比较 (Bool) 作为参数.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include "SmtEmitter.h"
+#include <unordered_map>
+
+class ParametricProperty {
+public:
+    ParametricProperty(const ASTNode *root, const SmtInformation &info);
+
+    // (define-fun Property (参数...) Bool 性质体)
+    void define(SmtSink &out) const;
+
+    // (Property 第 step 步的实参...)
+    void apply(unsigned step, SmtSink &out) const;
+
+    size_t parameter_count() const { return parameters.size(); }
+
+    // 叶子在某个相对时刻上的一次出现. 重复和化简合并的子树会让同一叶子出现在多个时刻
+    struct Occurrence {
+        const ASTNode *leaf;
+        unsigned offset;
+        bool operator==(const Occurrence &other) const { return leaf == other.leaf && offset == other.offset; }
+    };
+    struct OccurrenceHash {
+        size_t operator()(const Occurrence &key) const {
+            return std::hash<const void *>()(key.leaf) * 31 + key.offset;
+        }
+    };
+
+private:
+    struct Parameter {
+        const ASTNode *leaf;  // 实参就是 leaf 在 step + offset 时刻的展开
+        unsigned offset;
+        std::string name;
+        std::string sort;
+    };
+
+    void add_parameter(const ASTNode *leaf, unsigned offset, const std::string &sort);
+
+    const ASTNode *root;
+    const SmtInformation &info;
+    std::vector<Parameter> parameters;
+    std::unordered_map<Occurrence, size_t, OccurrenceHash> parameter_of;  // 叶子出现 -> 参数下标
+    std::unordered_map<std::string, size_t> parameter_by_key;  // 文本@偏移:sort -> 参数下标
+    std::unordered_map<std::string, unsigned> name_uses;       // 文本@偏移 -> 已用次数
+};
@@ -0,0 +1,76 @@
+#include "Profiler.h"
+#include <atomic>
+#include <cstdio>
+#include <sys/resource.h>
+
+// 线程在 trace 中的编号, 按第一次记录事件的顺序分配
+static unsigned thread_number() {
+    static std::atomic<unsigned> next{1};
+    static thread_local unsigned number = next.fetch_add(1);
+    return number;
+}
+
+Profiler::Profiler(bool keep_events) : keep_events(keep_events), origin(Clock::now()) {}
+
+void Profiler::record(const char *name, long long arg, Clock::time_point start, Clock::time_point end) {
+    double start_us = std::chrono::duration<double, std::micro>(start - origin).count();
+    double duration_us = std::chrono::duration<double, std::micro>(end - start).count();
+    unsigned thread = thread_number();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto inserted = phases.emplace(name, Phase());
+    if (inserted.second) {
+        phase_order.push_back(name);
+    }
+    Phase &phase = inserted.first->second;
+    phase.calls++;
+    phase.total_us += duration_us;
+    phase.max_us = std::max(phase.max_us, duration_us);
+    if (keep_events) {
+        events.push_back(Event{name, arg, thread, start_us, duration_us});
+    }
+}
+
+void Profiler::count(const std::string &name, unsigned long long value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters[name] += value;
+}
+
+void Profiler::write_stats(std::ostream &out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    char line[256];
+    out << "{\n  \"phases\": {";
+    for (size_t i = 0; i < phase_order.size(); i++) {
+        const Phase &phase = phases.at(phase_order[i]);
+        snprintf(line, sizeof(line), "%s\n    \"%s\": {\"calls\": %llu, \"total_ms\": %.3f, \"max_ms\": %.3f}",
+                 i == 0 ? "" : ",", phase_order[i].c_str(), phase.calls, phase.total_us / 1000, phase.max_us / 1000);
+        out << line;
+    }
+    out << "\n  },\n  \"counters\": {";
+    bool first = true;
+    for (const auto &[name, value] : counters) {
+        out << (first ? "\n    \"" : ",\n    \"") << name << "\": " << value;
+        first = false;
+    }
+    double wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - origin).count();
+    snprintf(line, sizeof(line), "\n  },\n  \"wall_ms\": %.3f,\n  \"peak_rss_kb\": %ld\n}\n", wall_ms, usage.ru_maxrss);
+    out << line;
+}
+
+void Profiler::write_trace(std::ostream &out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    char line[256];
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event &event = events[i];
+        int length = snprintf(line, sizeof(line), "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f",
+                              i == 0 ? "" : ",", event.name, event.thread, event.start_us, event.duration_us);
+        out.write(line, length);
+        if (event.arg >= 0) {
+            out << ", \"args\": {\"step\": " << event.arg << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,87 @@
+//
+// 阶段计时和计数: --stats 输出各阶段耗时, token/节点个数, 峰值 RSS 和输出字节数的 JSON,
+// --trace 输出 Chrome trace-event 文件 (chrome://tracing 或 Perfetto 打开).
+// 两者都关闭时没有 Profiler 实例, 每个 ProfileScope 只多一次指针判断.
+//
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // keep_events 为 false 时只累计各阶段的统计, 不保存逐个事件
+    explicit Profiler(bool keep_events);
+
+    // 当前进程使用的实例, 未启用时为空
+    static Profiler *active() { return current; }
+    static void activate(Profiler *profiler) { current = profiler; }
+
+    // 记录一个区间, arg 为负时不输出参数 (例如展开步号)
+    void record(const char *name, long long arg, Clock::time_point start, Clock::time_point end);
+    void count(const std::string &name, unsigned long long value);
+
+    void write_stats(std::ostream &out) const;
+    void write_trace(std::ostream &out) const;
+
+private:
+    struct Event {
+        const char *name;
+        long long arg;
+        unsigned thread;
+        double start_us;
+        double duration_us;
+    };
+    struct Phase {
+        unsigned long long calls = 0;
+        double total_us = 0;
+        double max_us = 0;
+    };
+
+    static inline Profiler *current = nullptr;
+
+    bool keep_events;
+    Clock::time_point origin;
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::vector<std::string> phase_order;  // 按第一次出现的顺序输出
+    std::map<std::string, Phase> phases;
+    std::map<std::string, unsigned long long> counters;
+};
+
+// 作用域计时, 未启用 Profiler 时什么也不做
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name, long long arg = -1) : profiler(Profiler::active()) {
+        if (profiler) {
+            this->name = name;
+            this->arg = arg;
+            start = Profiler::Clock::now();
+        }
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+    ~ProfileScope() {
+        if (profiler) {
+            profiler->record(name, arg, start, Profiler::Clock::now());
+        }
+    }
+
+private:
+    Profiler *profiler;
+    const char *name = nullptr;
+    long long arg = -1;
+    Profiler::Clock::time_point start;
+};
+
+inline void profile_count(const std::string &name, unsigned long long value) {
+    if (Profiler *profiler = Profiler::active()) {
+        profiler->count(name, value);
+    }
+}
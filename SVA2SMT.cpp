@@ -1,348 +1,596 @@
 #include "SVA2SMT.h"
+#include "SmtEmitter.h"
+#include <algorithm>
 #include <assert.h>
-#include <stack>
-
-extern std::vector<Token> tokens;
-extern SmtInformation Smt;
-
-static std::stack<Token> TokenStack;
-static std::stack<ASTNode *> AstStack;
-static size_t VecIndex;
-
-ASTNode *build_ast();
-static void act_stack_top();
-
-static void build_var_node();
-static void build_var_select_node();
-static void build_select_value_node();
-
-static void build_data_node();
-static void build_zx_data_node();
-static void build_paren_node();
-static void build_logic_node();
-static void build_compare_node();
-static void build_delay_node();
-static void build_overlap_node();
-
-// 解析器实现
-ASTNode *build_ast() {
-    for (VecIndex = 0; VecIndex < tokens.size(); VecIndex++) {
-        TokenStack.push(tokens[VecIndex]);
-        if (tokens[VecIndex].type == TokenType::RPAREN
-        || tokens[VecIndex].type == TokenType::RBRACKET
-        || tokens[VecIndex].type == TokenType::IDENTIFIER
-        || tokens[VecIndex].type == TokenType::XZ_VALUE) {
-            act_stack_top();
+#include <atomic>
+
+static unsigned parse_unsigned(std::string_view digits);
+static bool parse_range(std::string_view text, size_t prefix, unsigned &min, unsigned &max);
+
+// 运算符优先级解析 (shunting-yard 形式的优先级爬升), 用显式栈代替递归, 深层嵌套不会溢出调用栈.
+// 优先级从高到低: [*m:n] (后缀), 关系比较, ==/!=, &&, ||, ##N 与 ##[m:n] (右结合), |->/|=> (右结合),
+// 与 SystemVerilog 一致.
+// 每个 Parser 对象独立保存状态, 不同线程可以同时解析不同的断言.
+class Parser {
+public:
+    Parser(const std::vector<Token> &tokens, AstArena &arena) : tokens(tokens), arena(arena) {}
+
+    ASTNode *parse();
+
+private:
+    struct PendingOperator {
+        const Token *token;  // LPAREN 表示尚未闭合的括号
+        int precedence;
+    };
+
+    static int precedence(TokenType type);
+    static bool right_associative(TokenType type) {
+        return type == DELAY_CONTROL || type == DELAY_RANGE || type == OVERLAP || type == NOT_OVERLAP;
+    }
+
+    [[noreturn]] void fail(const std::string &message, size_t index) const;
+    const Token *peek(size_t index) const { return index < tokens.size() ? &tokens[index] : nullptr; }
+    size_t parse_operand(size_t index);
+    void reduce();
+
+    const std::vector<Token> &tokens;
+    AstArena &arena;
+    std::vector<ASTNode *> operands;
+    std::vector<PendingOperator> operators;
+};
+
+int Parser::precedence(TokenType type) {
+    switch (type) {
+        case LESS:
+        case LESS_EQUALS:
+        case GREATER:
+        case GREATER_EQUALS:
+            return 6;
+        case EQUALS:
+        case NOT_EQUALS:
+            return 5;
+        case AND:
+            return 4;
+        case OR:
+            return 3;
+        case DELAY_CONTROL:
+        case DELAY_RANGE:
+            return 2;
+        case OVERLAP:
+        case NOT_OVERLAP:
+            return 1;
+        default:
+            return 0;  // 不是二元运算符
+    }
+}
+
+void Parser::fail(const std::string &message, size_t index) const {
+    if (index < tokens.size()) {
+        throw ParseError(message + " near '" + std::string(tokens[index].value) + "'", tokens[index].offset);
+    }
+    size_t end = tokens.empty() ? 0 : tokens.back().offset + tokens.back().value.size();
+    throw ParseError(message + " at end of assertion", end);
+}
+
+// 标识符 (可带 [bit] 或 [msb:lsb]) 或常量, 返回其后的下标
+size_t Parser::parse_operand(size_t index) {
+    const Token &token = tokens[index];
+    switch (token.type) {
+        case IDENTIFIER: {
+            SymbolTable &symbols = arena.symbols();
+            Identifier *variable = arena.make<Identifier>(symbols, symbols.intern(token.value));
+            const Token *next = peek(index + 1);
+            if (!next || next->type != LBRACKET) {
+                operands.push_back(variable);
+                return index + 1;
+            }
+            const Token *first = peek(index + 2);
+            if (!first || first->type != BIT_SELECT) {
+                fail("expected a bit index", index + 2);
+            }
+            BitValue *msb = arena.make<BitValue>(parse_unsigned(first->value));
+            const Token *after = peek(index + 3);
+            if (after && after->type == RBRACKET) {
+                operands.push_back(arena.make<BitSelect>(variable, msb));
+                return index + 4;
+            }
+            if (!after || after->type != COLON) {
+                fail("expected ']' or ':' in select", index + 3);
+            }
+            const Token *second = peek(index + 4);
+            if (!second || second->type != BIT_SELECT) {
+                fail("expected the low bit index", index + 4);
+            }
+            const Token *close = peek(index + 5);
+            if (!close || close->type != RBRACKET) {
+                fail("expected ']'", index + 5);
+            }
+            BitValue *lsb = arena.make<BitValue>(parse_unsigned(second->value));
+            operands.push_back(arena.make<RangeSelect>(variable, msb, lsb));
+            return index + 6;
         }
+        case DATA_B:
+        case XZ_VALUE: {
+            size_t quote = token.value.find('\'');
+            unsigned width = parse_unsigned(token.value.substr(0, quote));
+            std::string data = token.type == DATA_B ? std::string(token.value.substr(quote + 2))
+                                                    : std::string(token.value.size() - quote - 2, '0');
+            operands.push_back(arena.make<DataValue>(width, data));
+            return index + 1;
+        }
+        case BIT_SELECT:
+            operands.push_back(arena.make<BitValue>(parse_unsigned(token.value)));
+            return index + 1;
+        default:
+            fail("expected an operand", index);
     }
-    assert(AstStack.size() == 1);
-    return AstStack.top();
-}
-
-static void act_stack_top() {
-    if (!TokenStack.empty()) {
-        switch(TokenStack.top().type) {
-            case TokenType::RPAREN:
-                build_paren_node();
-                break;
-            case TokenType::RBRACKET:
-                build_var_select_node();
-                break;
-            case TokenType::DELAY_CONTROL:
-                build_delay_node();
-                break;
-            case TokenType::AND:
-            case TokenType::OR:
-                build_logic_node();
-                break;
-            case TokenType::EQUALS:
-            case TokenType::NOT_EQUALS:
-            case TokenType::LESS_EQUALS:
-            case TokenType::GREATER_EQUALS:
-            case TokenType::LESS:
-            case TokenType::GREATER:
-                build_compare_node();
-                break;
-            case TokenType::IDENTIFIER:
-                build_var_node();
-                break;
-            case TokenType::BIT_SELECT:
-                build_select_value_node();
-                break;
-            case TokenType::DATA_B:
-                build_data_node();
-                break;
-            case TokenType::XZ_VALUE:
-                build_zx_data_node();
-                break;
-            case TokenType::OVERLAP:
-            case TokenType::NOT_OVERLAP:
-                build_overlap_node();
-                break;
-            default:
-                assert(false && "wrong case item check stack top here!");
-                break;
+}
+
+// 用栈顶运算符合并两个操作数
+void Parser::reduce() {
+    const Token &op = *operators.back().token;
+    operators.pop_back();
+    ASTNode *right = operands.back();
+    operands.pop_back();
+    ASTNode *left = operands.back();
+    operands.pop_back();
+    ASTNode *node = nullptr;
+    switch (op.type) {
+        case AND:
+        case OR:
+            node = arena.make<LogicAndOrOperation>(op.type == AND ? OP_AND : OP_OR, left, right);
+            break;
+        case DELAY_CONTROL:
+            node = arena.make<DelayControl>(parse_unsigned(op.value.substr(2)), left, right);
+            break;
+        case DELAY_RANGE: {
+            unsigned min = 0, max = 0;
+            parse_range(op.value, 3, min, max);  // 压栈前已检查
+            node = arena.make<DelayControl>(min, max, left, right);
+            break;
         }
+        case OVERLAP:
+        case NOT_OVERLAP:
+            node = arena.make<OverlapExpression>(left, right, op.type == NOT_OVERLAP);
+            break;
+        case EQUALS:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::EQUAL);
+            break;
+        case NOT_EQUALS:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::NEQUAL);
+            break;
+        case LESS_EQUALS:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::LEQUAL);
+            break;
+        case GREATER_EQUALS:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::GEQUAL);
+            break;
+        case LESS:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::LESS);
+            break;
+        default:
+            node = arena.make<CompareExpression>(left, right, CompareExpression::GREATER);
+            break;
     }
+    operands.push_back(node);
 }
 
-static void build_var_node() {
-    Token &top = TokenStack.top();
-    ASTNode *node = new Identifier(top.value);
-    AstStack.push(node);
-    TokenStack.pop();
+ASTNode *Parser::parse() {
+    bool expect_operand = true;
+    size_t index = 0;
+    while (index < tokens.size()) {
+        const Token &token = tokens[index];
+        if (expect_operand) {
+            if (token.type == LPAREN) {
+                operators.push_back(PendingOperator{&token, 0});
+                index++;
+            } else {
+                index = parse_operand(index);
+                expect_operand = false;
+            }
+            continue;
+        }
+        if (token.type == RPAREN) {
+            while (!operators.empty() && operators.back().token->type != LPAREN) {
+                reduce();
+            }
+            if (operators.empty()) {
+                fail("unmatched ')'", index);
+            }
+            operators.pop_back();
+            ASTNode *inner = operands.back();
+            operands.back() = arena.make<ParenExpression>(inner);
+            index++;
+            continue;
+        }
+        if (token.type == REPETITION) {
+            // 后缀, 作用于刚得到的操作数
+            unsigned min = 0, max = 0;
+            if (!parse_range(token.value, 2, min, max)) {
+                fail("malformed repetition", index);
+            }
+            if (min == 0) {
+                fail("empty repetition is not supported", index);
+            }
+            // 第 i 次重复放在第 i 个周期, 只对单周期的 Bool 操作数成立
+            if (operands.back()->spans_cycles()) {
+                fail("only a Boolean expression can be repeated, not a sequence", index);
+            }
+            operands.back() = arena.make<Repetition>(operands.back(), min, max);
+            index++;
+            continue;
+        }
+        int level = precedence(token.type);
+        if (level == 0) {
+            fail("expected an operator", index);
+        }
+        unsigned min = 0, max = 0;
+        if (token.type == DELAY_RANGE && !parse_range(token.value, 3, min, max)) {
+            fail("malformed delay range", index);
+        }
+        while (!operators.empty() && operators.back().token->type != LPAREN &&
+               (operators.back().precedence > level ||
+                (operators.back().precedence == level && !right_associative(token.type)))) {
+            reduce();
+        }
+        operators.push_back(PendingOperator{&token, level});
+        expect_operand = true;
+        index++;
+    }
+    if (expect_operand) {
+        fail(tokens.empty() ? "empty assertion" : "expected an operand", index);
+    }
+    while (!operators.empty()) {
+        if (operators.back().token->type == LPAREN) {
+            throw ParseError("unclosed '('", operators.back().token->offset);
+        }
+        reduce();
+    }
+    return operands.back();
 }
 
-static void build_var_select_node() {
-    bool range = false;
-    TokenStack.pop();
-    while (TokenStack.top().type != TokenType::LBRACKET) {
-        if (TokenStack.top().type == TokenType::BIT_SELECT) {
-            act_stack_top();
-        } else if (TokenStack.top().type == TokenType::COLON) {
-            range = true;
-            TokenStack.pop();
-        } else {
-            assert(false && "wrong case item check bit range here!");
+ASTNode *build_ast(const std::vector<Token> &tokens, AstArena &arena) {
+    return Parser(tokens, arena).parse();
+}
+
+static unsigned parse_unsigned(std::string_view digits) {
+    unsigned value = 0;
+    for (char c : digits) {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// "##[m:n]" / "[*m:$]" / "[*n]" 去掉前 prefix 个字符后的区间, $ 为 UNBOUNDED; 格式不对或 m > n 时返回 false
+static bool parse_range(std::string_view text, size_t prefix, unsigned &min, unsigned &max) {
+    if (text.size() < prefix + 2 || text.back() != ']') {
+        return false;
+    }
+    std::string_view body = text.substr(prefix, text.size() - prefix - 1);
+    size_t colon = body.find(':');
+    std::string_view low = body.substr(0, colon);
+    std::string_view high = colon == std::string_view::npos ? low : body.substr(colon + 1);
+    auto is_number = [](std::string_view digits) {
+        return !digits.empty() && std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (!is_number(low) || !(is_number(high) || (colon != std::string_view::npos && high == "$"))) {
+        return false;
+    }
+    min = parse_unsigned(low);
+    max = high == "$" ? UNBOUNDED : parse_unsigned(high);
+    return min <= max;
+}
+
+void *AstArena::allocate(size_t size, size_t align) {
+    size_t offset = (used + align - 1) & ~(align - 1);
+    if (offset + size > BLOCK_SIZE) {
+        blocks.emplace_back(new unsigned char[BLOCK_SIZE]);
+        offset = 0;
+    }
+    used = offset + size;
+    return blocks.back().get() + offset;
+}
+
+unsigned long long SymbolTable::next_serial() {
+    static std::atomic<unsigned long long> counter{0};
+    return ++counter;
+}
+
+static const unsigned EMPTY_SLOT = ~0u;
+
+static size_t hash_name(std::string_view name) {
+    size_t hash = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+unsigned SymbolTable::intern(std::string_view name) {
+    // 装载率不超过 1/2
+    if ((names.size() + 1) * 2 > slots.size()) {
+        grow();
+    }
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash_name(name) & mask;; i = (i + 1) & mask) {
+        if (slots[i] == EMPTY_SLOT) {
+            slots[i] = static_cast<unsigned>(names.size());
+            names.emplace_back(name);
+            return slots[i];
+        }
+        if (names[slots[i]] == name) {
+            return slots[i];
         }
     }
+}
 
-    if (range) {
-        BitValue *left = dynamic_cast<BitValue *>(AstStack.top());
-        AstStack.pop();
-        BitValue *right = dynamic_cast<BitValue *>(AstStack.top());
-        AstStack.pop();
-        Identifier *var = dynamic_cast<Identifier *>(AstStack.top());
-        AstStack.pop();
-        ASTNode *node = new RangeSelect(var, left, right);
-        AstStack.push(node);
-    } else {
-        BitValue *selector = dynamic_cast<BitValue *>(AstStack.top());
-        AstStack.pop();
-        Identifier *var = dynamic_cast<Identifier *>(AstStack.top());
-        AstStack.pop();
-        ASTNode *node = new BitSelect(var, selector);
-        AstStack.push(node);
+void SymbolTable::grow() {
+    slots.assign(slots.empty() ? 64 : slots.size() * 2, EMPTY_SLOT);
+    size_t mask = slots.size() - 1;
+    for (unsigned symbol = 0; symbol < names.size(); symbol++) {
+        size_t i = hash_name(names[symbol]) & mask;
+        while (slots[i] != EMPTY_SLOT) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = symbol;
     }
-    TokenStack.pop();
-}
-
-static void build_select_value_node() {
-    Token &top = TokenStack.top();
-    ASTNode *node = new BitValue(atoi(top.value.c_str()));
-    AstStack.push(node);
-    TokenStack.pop();
-}
-
-static void build_data_node() {
-    Token &top = TokenStack.top();
-    std::smatch match;
-    std::regex str("[0-9]+");
-    std::regex_search(top.value.cbegin(), top.value.cend(), match, str);
-    std::string res = std::string(match[0]);
-    unsigned width = atoi(res.c_str());
-    std::string value = std::string(top.value, res.length() + 2, top.value.length());
-    ASTNode *node = new DataValue(width, value);
-    AstStack.push(node);
-    TokenStack.pop();
-}
-
-static void build_zx_data_node() {
-    Token &top = TokenStack.top();
-    std::smatch match;
-    std::regex str("[0-9]+");
-    std::regex_search(top.value.cbegin(), top.value.cend(), match, str);
-    std::string res = std::string(match[0]);
-    unsigned width = atoi(res.c_str());
-    std::string value = std::string(top.value.length() - res.length() - 2, '0');
-    ASTNode *node = new DataValue(width, value);
-    AstStack.push(node);
-    TokenStack.pop();
-}
-
-static void build_paren_node() {
-    TokenStack.pop();
-    while (TokenStack.top().type != TokenType::LPAREN) {
-        act_stack_top();
+}
+
+void SymbolTable::clear() {
+    names.clear();
+    std::fill(slots.begin(), slots.end(), EMPTY_SLOT);  // 保留容量, 池被反复使用时不再扩容
+    serial = next_serial();
+}
+
+void AstArena::clear() {
+    for (ASTNode *node : nodes) {
+        node->~ASTNode();
     }
-    assert(!AstStack.empty());
-    ASTNode *node = new ParenExpression(AstStack.top());
-    AstStack.pop();
-    AstStack.push(node);
-    TokenStack.pop();
-}
-
-static void build_logic_node() {
-    assert(AstStack.size() >= 2);
-    ASTNode *right = AstStack.top();
-    AstStack.pop();
-    ASTNode *left = AstStack.top();
-    AstStack.pop();
-    BinaryOperator op = TokenStack.top().type == TokenType::AND ? BinaryOperator::OP_AND : BinaryOperator::OP_OR;
-    ASTNode *node = new LogicAndOrOperation(op, left, right);
-    AstStack.push(node);
-    TokenStack.pop();
-}
-
-static void build_compare_node() {
-    assert(AstStack.size() >= 2);
-    ASTNode *right = AstStack.top();
-    AstStack.pop();
-    ASTNode *left = AstStack.top();
-    AstStack.pop();
-
-    CompareExpression::CompareType type;
-
-    switch (TokenStack.top().type)
-    {
-    case TokenType::EQUALS:
-        type = CompareExpression::CompareType::EQUAL;
-        break;
-    case TokenType::NOT_EQUALS:
-        type = CompareExpression::CompareType::NEQUAL;
-        break;
-    case TokenType::LESS_EQUALS:
-        type = CompareExpression::CompareType::LEQUAL;
-        break;
-    case TokenType::GREATER_EQUALS:
-        type = CompareExpression::CompareType::GEQUAL;
-        break;
-    case TokenType::LESS:
-        type = CompareExpression::CompareType::LESS;
-        break;
-    case TokenType::GREATER:
-        type = CompareExpression::CompareType::GREATER;
-        break;
-        default:
-        assert(false && "unsupported compare expression!");
-        break;
+    nodes.clear();
+    blocks.clear();
+    used = BLOCK_SIZE;
+    symbol_table.clear();
+}
+
+std::string ASTNode::to_string() const {
+    std::string out;
+    ExpandStack work{expand_node(this)};
+    while (!work.empty()) {
+        ExpandItem item = work.back();
+        work.pop_back();
+        if (item.node) {
+            item.node->expand_string(item.stage, work, out);
+        } else {
+            out += item.text;
+        }
     }
+    return out;
+}
 
-    ASTNode *node = new CompareExpression(left, right, type);
+std::string ASTNode::to_smt_lib2(unsigned time, const SmtInformation &info) const {
+    std::string out;
+    StringSink sink(out);
+    SmtEmitter emitter(sink, info);
+    emitter.emit(this, time);
+    return out;
+}
 
-    AstStack.push(node);
-    TokenStack.pop();
+// 子树中是否有满足 match 的节点
+template <typename Match>
+static bool contains(const ASTNode *root, Match match) {
+    std::vector<const ASTNode *> work{root};
+    while (!work.empty()) {
+        const ASTNode *node = work.back();
+        work.pop_back();
+        if (match(node)) {
+            return true;
+        }
+        for (size_t i = 0; i < node->child_count(); i++) {
+            work.push_back(node->child(i));
+        }
+    }
+    return false;
 }
 
-static void build_delay_node() {
-    assert(AstStack.size() >= 2);
-    ASTNode *right = AstStack.top();
-    AstStack.pop();
-    ASTNode *left = AstStack.top();
-    AstStack.pop();
-    std::string value = std::string(TokenStack.top().value, 2, TokenStack.top().value.length());
-    unsigned delay = atoi(value.c_str());
-    ASTNode *node = new DelayControl(delay, left, right);
-    AstStack.push(node);
-    TokenStack.pop();
+bool ASTNode::has_overlap() const {
+    return contains(this, [](const ASTNode *node) { return node->is_temporal(); });
 }
 
-static void build_overlap_node() {
-    assert(AstStack.size() >= 2);
-    ASTNode *right = AstStack.top();
-    AstStack.pop();
-    ASTNode *left = AstStack.top();
-    AstStack.pop();
-    bool delay = TokenStack.top().type == NOT_OVERLAP;
-    ASTNode *node = new OverlapExpression(left, right, delay);
-    AstStack.push(node);
-    TokenStack.pop();
+bool ASTNode::spans_cycles() const {
+    return contains(this, [](const ASTNode *node) { return node->is_temporal() || node->kind() == NODE_REPEAT; });
 }
 
-std::string Identifier::to_smt_lib2(unsigned time) const {
-    return GET_DECLARE_NAME(Smt, name, time);
+void Identifier::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write_signal(*this, time);
 }
 
-std::string BitValue::to_smt_lib2(unsigned time) const {
-    return std::to_string(value);
+void BitValue::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write(static_cast<unsigned long long>(value));
 }
 
-std::string DataValue::to_smt_lib2(unsigned time) const {
-    std::string res = "#b" + data;
-    return res;
+void DataValue::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write("#b");
+    emitter.write(data);
 }
 
-std::string BitSelect::to_smt_lib2(unsigned time) const {
-    std::string bit = selector->to_smt_lib2(time);
-    std::string var = variable->to_smt_lib2(time);
-    std::string res = "(_ extract " + bit + " " + bit + " (" + var + "))";
-    return res;
+void BoolValue::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write(value ? "true" : "false");
 }
 
-std::string RangeSelect::to_smt_lib2(unsigned time) const {
-    std::string left = left_selector->to_smt_lib2(time);
-    std::string right = right_selector->to_smt_lib2(time);
-    std::string var = variable->to_smt_lib2(time);
-    std::string res = "(_ extract " + left + " " + right + " (" + var + "))";
-    return res;
+void BitSelect::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write("(_ extract ");
+    emitter.push("))");
+    emitter.push(variable, time);
+    emitter.push(" (");
+    emitter.push(selector, time);
+    emitter.push(" ");
+    emitter.push(selector, time);
 }
 
-std::string LogicAndOrOperation::to_smt_lib2(unsigned time) const {
-    std::string l_smt = left->to_smt_lib2(time);
-    std::string r_smt = right->to_smt_lib2(time);
-    std::string bv_op = op == BinaryOperator::OP_AND ? "and" : "or";
-    std::string res = "(" + bv_op + " " + l_smt + " " + r_smt + ")";
-    return res;
+void RangeSelect::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write("(_ extract ");
+    emitter.push("))");
+    emitter.push(variable, time);
+    emitter.push(" (");
+    emitter.push(right_selector, time);
+    emitter.push(" ");
+    emitter.push(left_selector, time);
 }
 
-std::string DelayControl::to_smt_lib2(unsigned time) const {
-    std::string l_smt = left->to_smt_lib2(time);
-    std::string r_smt = right->to_smt_lib2(time + delay * TIME_CLOCK);
-    std::string res;
-    if (Smt.NeedFalse) {
-        res = "(and " + l_smt + " (not " + r_smt + "))";
-    } else {
-        res = "(and " + l_smt + " " + r_smt + ")";
+void LogicAndOrOperation::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.write(op == BinaryOperator::OP_AND ? "(and " : "(or ");
+    emitter.push(")");
+    for (size_t i = count; i != 0; i--) {
+        emitter.push(operands[i - 1], time);
+        if (i != 1) {
+            emitter.push(" ");
+        }
+    }
+}
+
+const Repetition *DelayControl::left_repetition() const {
+    const ASTNode *node = left;
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    return node->kind() == NODE_REPEAT ? static_cast<const Repetition *>(node) : nullptr;
+}
+
+// 左操作数在第 first..last 个周期结束, 每个结束周期之后 r 可以在 delay..max 个周期后成立
+unsigned DelayControl::child_span(size_t index, unsigned horizon) const {
+    if (index == 0) {
+        return 1;
     }
-    return res;
+    const Repetition *repetition = left_repetition();
+    unsigned ends = repetition ? repetition->get_max(horizon) - repetition->get_min() : 0;
+    return ends + get_max_delay(horizon) - delay + 1;
 }
 
-std::string ParenExpression::to_smt_lib2(unsigned time) const {
-    return expression->to_smt_lib2(time);
+void Repetition::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    if (min == 1) {
+        emitter.push(operand, time);
+        return;
+    }
+    emitter.write("(and ");
+    emitter.push(")");
+    for (unsigned i = min; i != 0; i--) {
+        emitter.push(operand, time + (i - 1) * TIME_CLOCK);
+        if (i != 1) {
+            emitter.push(" ");
+        }
+    }
 }
 
-std::string OverlapExpression::to_smt_lib2(unsigned time) const {
-    std::string l_smt = left->to_smt_lib2(time);
-    std::string r_smt = right->to_smt_lib2(delay ? time + TIME_CLOCK : time);
-    std::string res;
-    if (Smt.NeedFalse) {
-        res = "(and " + l_smt + " (not " + r_smt + "))";
-    } else {
-        res = "(and " + l_smt + " " + r_smt + ")";
+void DelayControl::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    const Repetition *repetition = left_repetition();
+    if (is_range() || repetition) {
+        emit_range(time, repetition, emitter);
+        return;
     }
-    return res;
+    emitter.write("(and ");
+    emitter.push("))", POLARITY_NEGATIVE);
+    emitter.push(")", POLARITY_POSITIVE);
+    emitter.push(right, child_time(1, time));
+    emitter.push(" (not ", POLARITY_NEGATIVE);
+    emitter.push(" ", POLARITY_POSITIVE);
+    emitter.push(left, time);
+}
+
+// (and l R), NeedFalse 时 (and l (not R)). l 为 b[*first:last] (不是重复时 first = last = 1), 在第 j 个
+// 周期结束后 delay..high 个周期内 r 成立. 按 r 成立的周期 m 归并: b 持续到 j 的条件随 j 变强, 每个 m
+// 只需看最早可用的 j, 而它随 m 每次至多加 1. 于是 (周期相对于 time)
+//   R = (or r@(first-1+delay) ... r@(first-1+high) L_1),  L_i = (and b@(first+i-1) (or r@(first-1+high+i) L_{i+1}))
+// 共 last-first 环, 最后一环没有 L_{i+1}. 每个 r 和 b 只出现一次, 规模与区间宽度成线性;
+// 嵌套的区间由共享子项 (define-fun) 保持线性, 见 Unroller
+void DelayControl::emit_range(unsigned time, const Repetition *repetition, SmtEmitter &emitter) const {
+    const unsigned horizon = emitter.options().Time;
+    const unsigned first = repetition ? repetition->get_min() : 1;
+    const unsigned links = repetition ? repetition->get_max(horizon) - first : 0;
+    const unsigned high = get_max_delay(horizon);
+
+    // 按输出顺序收集, 再逆序压栈
+    ExpandStack items{expand_node(left, time), expand_text(" "), expand_text("(not ", POLARITY_NEGATIVE)};
+    const bool window = high != delay || links != 0;
+    if (window) {
+        items.push_back(expand_text("(or "));
+    }
+    for (unsigned k = delay; k <= high; k++) {
+        items.push_back(expand_node(right, time + (first - 1 + k) * TIME_CLOCK));
+        items.push_back(expand_text(k == high && links == 0 ? "" : " "));
+    }
+    for (unsigned i = 1; i <= links; i++) {
+        items.push_back(expand_text("(and "));
+        items.push_back(expand_node(repetition->get_operand(), time + (first + i - 1) * TIME_CLOCK));
+        items.push_back(expand_text(i == links ? " " : " (or "));
+        items.push_back(expand_node(right, time + (first - 1 + high + i) * TIME_CLOCK));
+        items.push_back(expand_text(i == links ? ")" : " "));
+    }
+    for (unsigned i = 1; i < links; i++) {
+        items.push_back(expand_text("))"));
+    }
+    if (window) {
+        items.push_back(expand_text(")"));
+    }
+    items.push_back(expand_text(")", POLARITY_NEGATIVE));
+    items.push_back(expand_text(")"));
+
+    emitter.write("(and ");
+    for (size_t i = items.size(); i != 0; i--) {
+        const ExpandItem &item = items[i - 1];
+        if (item.node) {
+            emitter.push(item.node, item.time);
+        } else if (!item.text.empty()) {
+            emitter.push(item.text, static_cast<Polarity>(item.stage));
+        }
+    }
+}
+
+void ParenExpression::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    emitter.push(expression, time);
+}
+
+void OverlapExpression::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    unsigned right_time = child_time(1, time);
+    emitter.write("(and ");
+    emitter.push("))", POLARITY_NEGATIVE);
+    emitter.push(")", POLARITY_POSITIVE);
+    emitter.push(right, right_time);
+    emitter.push(" (not ", POLARITY_NEGATIVE);
+    emitter.push(" ", POLARITY_POSITIVE);
+    emitter.push(left, time);
 }
 
-std::string CompareExpression::to_smt_lib2(unsigned time) const {
-    std::string l_smt = left->to_smt_lib2(time);
-    std::string r_smt = right->to_smt_lib2(time);
-    std::string bv_op;
+void CompareExpression::emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const {
+    const char *bv_op = "";
 
     switch (type)
         {
         case CompareExpression::CompareType::EQUAL:
-            bv_op = "=";
+            bv_op = "(= ";
             break;
         case CompareExpression::CompareType::NEQUAL:
-            bv_op = "distinct";
+            bv_op = "(distinct ";
             break;
         case CompareExpression::CompareType::LEQUAL:
-            bv_op = "bvule";
+            bv_op = "(bvule ";
             break;
         case CompareExpression::CompareType::GEQUAL:
-            bv_op = "bvuge";
+            bv_op = "(bvuge ";
             break;
         case CompareExpression::CompareType::LESS:
-            bv_op = "bvult";
+            bv_op = "(bvult ";
             break;
         case CompareExpression::CompareType::GREATER:
-            bv_op = "bvugt";
+            bv_op = "(bvugt ";
             break;
         default:
             assert(false && "unsupported compare expression!");
             break;
         }
 
-    std::string res = "(" + bv_op + " " + l_smt + " " + r_smt + ")";
-    return res;
+    emitter.write(bv_op);
+    emitter.push(")");
+    emitter.push(right, time);
+    emitter.push(" ");
+    emitter.push(left, time);
 }
@@ -1,9 +1,14 @@
+#pragma once
 #include <iostream>
+#include <deque>
 #include <vector>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
 
-#define TOKEN_TYPE_NUM 20
 #define TIME_CLOCK 2
 #define GET_DECLARE_NAME(generator, var, time) ("testbench." + generator.ModuleName + "_instance." + var + "_" + std::to_string(time) + "_1")
 
@@ -16,6 +21,8 @@ enum TokenType {
     AND,
     OR,
     DELAY_CONTROL,
+    DELAY_RANGE,  // ##[1:3] / ##[1:$]
+    REPETITION,   // [*2] / [*1:3] / [*1:$]
     EQUALS,  // ==
     NOT_EQUALS, // !=
     LESS_EQUALS, // <=
@@ -32,40 +39,49 @@ enum TokenType {
     OTHER
 };
 
-// Token结构
+// Token结构, value 指向源缓冲区, 源缓冲区必须比 token 活得久
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
+    size_t offset;  // value 在源缓冲区中的起始偏移
 };
 
+// ##[m:$] 和 [*m:$] 中的 $: 取到展开界为止, 见 unbounded_cycles
+constexpr unsigned UNBOUNDED = ~0u;
+
+// 展开界 horizon (即 Time) 内的周期数, 从第一步起 ##[0:$] 最多延时到最后一步
+inline unsigned unbounded_cycles(unsigned horizon) {
+    return horizon / TIME_CLOCK;
+}
+
 // 二进制操作符枚举
 enum BinaryOperator {
     OP_AND,
     OP_OR,
 };
 
-// 正则表达式模式
-const std::regex regexPatterns[] = {
-    std::regex("[a-zA-Z_][a-zA-Z_0-9]*"), // IDENTIFIER
-    std::regex("\\d+'[bB][01]+"), // DATA_B
-    std::regex("\\d+'[bB][xz]+"),  // XZ_VALUE
-    std::regex("[0-9]+"), // BIT_SELECT
-    std::regex("\\&\\&"), // LOGIC_AND
-    std::regex("\\|\\|"), // LOGIC_OR
-    std::regex("##\\d+"), // DELAY_CONTROL
-    std::regex("=="), // EQUALS
-    std::regex("!="), // NOT_EQUALS
-    std::regex("\\<="), // LESS_EQUAL
-    std::regex("\\>="), // GREATER_EQUAL
-    std::regex("\\<"),  // LESS
-    std::regex("\\>"),  // GREATER
-    std::regex("\\|->"), // OVERLAP
-    std::regex("\\|=>"), // NOT_OVERLAP
-    std::regex("\\("), // LPAREN
-    std::regex("\\)"), // RPAREN
-    std::regex("\\:"), // COLON
-    std::regex("\\["), // LBRACKET
-    std::regex("\\]")  // RBRACKET
+// 单遍词法分析, 返回的 token 指向 input
+std::vector<Token> tokenize(std::string_view input);
+
+// 断言无法解析时抛出, offset 为出错处在 token 所指的源缓冲区中的偏移
+class ParseError : public std::runtime_error {
+public:
+    ParseError(const std::string &message, size_t offset)
+        : std::runtime_error(message + " (offset " + std::to_string(offset) + ")"), text(message), position(offset) {}
+
+    const std::string &message() const { return text; }
+    size_t offset() const { return position; }
+
+private:
+    std::string text;
+    size_t position;
+};
+
+// 输出格式
+enum OutputFormat {
+    FORMAT_SMT_LIB2,
+    FORMAT_CNF,  // DIMACS CNF 和变量表, 见 CnfWriter.h
+    FORMAT_BTOR2,  // 不展开的时序监视器, 见 BtorWriter.h
 };
 
 struct SmtInformation {
@@ -74,51 +90,215 @@ struct SmtInformation {
     std::string ModuleName;
     unsigned Time;
     bool NeedFalse;
+    bool ShareTerms = false;  // 以 define-fun 共享 (子项, 时刻) 相同的子式
+    unsigned Jobs = 1;        // 展开各步时使用的线程数
+    unsigned Shards = 0;      // 非 0 时把各步分成这么多个独立的输出文件, 见 write_shards
+    bool Parametric = false;  // 性质只以 define-fun 输出一次, 每步只写一次应用
+    std::map<std::string, std::string> SignalSorts;  // 用户给定的信号 sort, 如 data -> (_ BitVec 8)
+    bool Incremental = false;  // 每步之后 push/check-sat/pop, 不写最后的析取
+    std::string SolverCommand; // 增量模式下把脚本送入该求解器进程的标准输入
+    std::string PreludeFile;   // 输出开头原样拷贝的文件, 通常是设计的声明和约束
+    std::string CacheDirectory;  // 非空时使用该目录下的翻译缓存
+    unsigned long long CacheLimit = 1ULL << 30;  // 缓存总大小上限, 字节
+    bool Stats = false;     // 结束时输出各阶段统计的 JSON
+    bool Simplify = false;  // 输出前化简 AST, 见 Simplify.h
+    bool Declare = false;   // 为每个用到的 (信号, 时刻) 输出 declare-const
+    int NegateRoot = -1;    // 根节点是否取反: -1 按 NeedFalse 和 has_overlap 判断, 化简前固定为 0/1
+    std::string TraceFile;  // 非空时写出 Chrome trace-event 文件
+    std::string SaveAstFile;  // 非空时把解析得到的 AST 存为预编译映像, 见 AstImage.h
+    OutputFormat Format = FORMAT_SMT_LIB2;
+    bool Verbose = false;   // 回显提取到的断言和解析结果, 输出结束后报告写出速度
+    bool DirectIo = false;  // 输出文件以 O_DIRECT 打开, 见 FileWriter.h
+    int GzipLevel = -1;        // >= 0 时输出为该级别的 gzip 流, 见 GzipWriter.h
+    bool GzipThread = false;   // 在单独的线程上压缩
+    bool DualPolarity = false;       // 一次展开同时写出两种极性, 输出端须为 DualSink; NeedFalse 只决定主输出
+    std::string DualOutputFileName;  // 双极性模式下另一种极性的输出文件
+};
+
+// 输出的极性: NeedFalse 时为取反的违例查询, 否则为不取反的覆盖查询. 作为掩码标记只属于一种极性的文本
+enum Polarity : unsigned {
+    POLARITY_NEGATIVE = 1,
+    POLARITY_POSITIVE = 2,
+    POLARITY_BOTH = 3,
+};
+
+inline Polarity output_polarity(const SmtInformation &info) {
+    return info.NeedFalse ? POLARITY_NEGATIVE : POLARITY_POSITIVE;
+}
+
+class ASTNode;
+class SmtEmitter;
+
+// 节点种类, 供各个遍历 pass 分派
+enum NodeKind {
+    NODE_IDENTIFIER,
+    NODE_BIT_VALUE,
+    NODE_DATA_VALUE,
+    NODE_BIT_SELECT,
+    NODE_RANGE_SELECT,
+    NODE_LOGIC,
+    NODE_DELAY,
+    NODE_PAREN,
+    NODE_OVERLAP,
+    NODE_COMPARE,
+    NODE_BOOL_VALUE,
+    NODE_REPEAT,
 };
 
+// 非递归遍历的工作项: node 为空时直接输出 text, 这时 stage 为 text 所属的极性 (Polarity);
+// 否则按 stage 继续展开 node
+struct ExpandItem {
+    const ASTNode *node;
+    unsigned time;
+    unsigned stage;
+    std::string_view text;
+};
+
+using ExpandStack = std::vector<ExpandItem>;
+
+inline ExpandItem expand_text(std::string_view text, Polarity polarity = POLARITY_BOTH) {
+    return ExpandItem{nullptr, 0, polarity, text};
+}
+
+inline ExpandItem expand_node(const ASTNode *node, unsigned time = 0, unsigned stage = 0) {
+    return ExpandItem{node, time, stage, {}};
+}
+
 class ASTNode {
 public:
     virtual ~ASTNode() {}  // Ensure a virtual destructor for proper cleanup.
 
-    virtual std::string to_string() const = 0;
-    // Other common methods and properties shared among all AST nodes can be defined here.
-    virtual std::string to_smt_lib2(unsigned time) const = 0;
+    virtual NodeKind kind() const = 0;
+
+    // 以下的遍历都用显式栈实现, 深层的 &&/|| 链不会导致栈溢出
+    std::string to_string() const;
+    bool has_overlap() const;
+    // 子树是否跨越多个周期 (含时序算子或重复), 这样的子树不能作为重复的操作数
+    bool spans_cycles() const;
+
+    // 旧接口, 内部经由 SmtEmitter 写入字符串
+    std::string to_smt_lib2(unsigned time, const SmtInformation &info) const;
+
+    // 把本节点的文本写入 out, 子节点和剩余片段逆序压入 work
+    virtual void expand_string(unsigned stage, ExpandStack &work, std::string &out) const = 0;
+    // 同上, 输出 time 时刻的 SMT-LIB2, 文本直接写入 emitter 的 sink
+    virtual void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const = 0;
+
+    virtual size_t child_count() const { return 0; }
+    virtual const ASTNode *child(size_t index) const { return nullptr; }
+    // 第 index 个子节点在 SMT 中展开时所处的时刻
+    virtual unsigned child_time(size_t index, unsigned time) const { return time; }
+    // 第 index 个子节点展开的时刻个数: 从 child_time 起每隔 TIME_CLOCK 一个. 只有区间延时和重复
+    // 会大于 1, horizon 为展开界 Time, 决定 $ 的取值
+    virtual unsigned child_span(size_t index, unsigned horizon) const { return 1; }
+
+    // 节点自身的结构特征 (不含子节点), 结构相同的子树据此合并
+    virtual std::string signature() const = 0;
+
+    // 自身是否为时序算子 (##N, |->, |=>)
+    virtual bool is_temporal() const { return false; }
+    // 展开结果是否为 Bool, 只有 Bool 子项可以被 define-fun 共享
+    virtual bool is_boolean() const { return false; }
+};
+
+// 标识符驻留表: 同名标识符共用一个编号和一份字符串
+class SymbolTable {
+public:
+    SymbolTable() : serial(next_serial()) {}
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    unsigned intern(std::string_view name);
+    const std::string &name(unsigned symbol) const { return names[symbol]; }
+    size_t size() const { return names.size(); }
+    // 每个表 (以及每次 clear) 不同, 供按符号编号建立的缓存判断是否失效
+    unsigned long long generation() const { return serial; }
+
+    void clear();
+
+private:
+    static unsigned long long next_serial();
+    void grow();
 
-    virtual bool has_overlap() const = 0;
+    std::deque<std::string> names;  // deque 保证已驻留的字符串地址不变
+    std::vector<unsigned> slots;    // 开放寻址的哈希表, 存符号编号, EMPTY_SLOT 表示空
+    unsigned long long serial;
 };
 
-// 标识符节点
+// AST 节点池: 节点按块连续分配, 随池一起释放
+class AstArena {
+public:
+    AstArena() = default;
+    AstArena(const AstArena &) = delete;
+    AstArena &operator=(const AstArena &) = delete;
+    ~AstArena() { clear(); }
+
+    template <typename T, typename... Args>
+    T *make(Args &&... args) {
+        static_assert(sizeof(T) <= BLOCK_SIZE, "node larger than arena block");
+        T *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        nodes.push_back(node);
+        return node;
+    }
+
+    size_t size() const { return nodes.size(); }
+    size_t bytes() const { return blocks.size() * BLOCK_SIZE; }
+
+    // 池中标识符的驻留表, 与节点一起清空
+    SymbolTable &symbols() { return symbol_table; }
+
+    void clear();
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    void *allocate(size_t size, size_t align);
+
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    std::vector<ASTNode *> nodes;
+    size_t used = BLOCK_SIZE;
+    SymbolTable symbol_table;
+};
+
+// 标识符节点, 名字驻留在 AstArena 的符号表中
 class Identifier : public ASTNode {
 public:
-    Identifier(const std::string& name) : name(name) {}
+    Identifier(const SymbolTable &symbols, unsigned symbol)
+        : symbols(symbols), symbol(symbol), name(symbols.name(symbol)) {}
+
+    NodeKind kind() const override { return NODE_IDENTIFIER; }
+    const std::string &get_name() const { return name; }
+    unsigned get_symbol() const { return symbol; }
+    const SymbolTable &get_symbols() const { return symbols; }
 
-    std::string to_string() const override {
-        return name;
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        out += name;
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return false;
-    }
+    std::string signature() const override { return "id:" + name; }
 
 private:
-    std::string name;
+    const SymbolTable &symbols;
+    unsigned symbol;
+    const std::string &name;
 };
 
 class BitValue : public ASTNode {
 public:
     BitValue(const int& value) : value(value) {}
 
-    std::string to_string() const override {
-        return std::to_string(value);
+    NodeKind kind() const override { return NODE_BIT_VALUE; }
+    int get_value() const { return value; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        out += std::to_string(value);
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return false;
-    }
+    std::string signature() const override { return "bit:" + std::to_string(value); }
 
 private:
     int value;
@@ -128,21 +308,42 @@ class DataValue : public ASTNode {
 public:
     DataValue(const unsigned& width, const std::string& data) : width(width), data(data) {}
 
-    std::string to_string() const override {
-        return std::to_string(width) + "'b" + data;
+    NodeKind kind() const override { return NODE_DATA_VALUE; }
+    unsigned get_width() const { return width; }
+    const std::string &get_data() const { return data; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        out += std::to_string(width) + "'b" + data;
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return false;
-    }
+    std::string signature() const override { return "data:" + std::to_string(width) + ":" + data; }
 
 private:
     unsigned width;
     std::string data;
 };
 
+// 化简得到的布尔常量
+class BoolValue : public ASTNode {
+public:
+    BoolValue(bool value) : value(value) {}
+
+    NodeKind kind() const override { return NODE_BOOL_VALUE; }
+    bool get_value() const { return value; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        out += value ? "1'b1" : "1'b0";
+    }
+
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
+
+    std::string signature() const override { return value ? "true" : "false"; }
+
+private:
+    bool value;
+};
 
 // 变量位选节点
 class BitSelect : public ASTNode {
@@ -150,14 +351,24 @@ public:
     BitSelect(Identifier* variable, BitValue* selector)
             : variable(variable), selector(selector) {}
 
-    std::string to_string() const override {
-        return variable->to_string() + "[" + selector->to_string() + "]";
+    NodeKind kind() const override { return NODE_BIT_SELECT; }
+    const Identifier *get_variable() const { return variable; }
+    int get_bit() const { return selector->get_value(); }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        work.push_back(expand_text("]"));
+        work.push_back(expand_node(selector));
+        work.push_back(expand_text("["));
+        work.push_back(expand_node(variable));
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
+
+    std::string signature() const override { return "select"; }
 
-    bool has_overlap() const override {
-        return false;
+    size_t child_count() const override { return 2; }
+    const ASTNode *child(size_t index) const override {
+        return index == 0 ? static_cast<const ASTNode *>(variable) : selector;
     }
 
 private:
@@ -171,14 +382,31 @@ public:
     RangeSelect(Identifier* variable, BitValue* left_selector, BitValue* right_selector)
         : variable(variable), left_selector(left_selector), right_selector(right_selector) {}
 
-    std::string to_string() const override {
-        return variable->to_string() + "[" + left_selector->to_string() + ":" + right_selector->to_string() + "]";
+    NodeKind kind() const override { return NODE_RANGE_SELECT; }
+    const Identifier *get_variable() const { return variable; }
+    int get_msb() const { return left_selector->get_value(); }
+    int get_lsb() const { return right_selector->get_value(); }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        work.push_back(expand_text("]"));
+        work.push_back(expand_node(right_selector));
+        work.push_back(expand_text(":"));
+        work.push_back(expand_node(left_selector));
+        work.push_back(expand_text("["));
+        work.push_back(expand_node(variable));
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return false;
+    std::string signature() const override { return "range"; }
+
+    size_t child_count() const override { return 3; }
+    const ASTNode *child(size_t index) const override {
+        switch (index) {
+            case 0: return variable;
+            case 1: return left_selector;
+            default: return right_selector;
+        }
     }
 
 private:
@@ -187,46 +415,148 @@ private:
     BitValue* right_selector;
 };
 
-// 与/或运算节点
+// 与/或运算节点, 解析得到的是二元形式, 化简后可以是 n 元
 class LogicAndOrOperation : public ASTNode {
 public:
     LogicAndOrOperation(BinaryOperator op, ASTNode* left, ASTNode* right)
-            : op(op), left(left), right(right) {}
+            : op(op), pair{left, right}, operands(pair), count(2) {}
+    LogicAndOrOperation(BinaryOperator op, std::vector<ASTNode *> list)
+            : op(op), pair{}, many(std::move(list)), operands(many.data()), count(many.size()) {}
+    LogicAndOrOperation(const LogicAndOrOperation &) = delete;
+    LogicAndOrOperation &operator=(const LogicAndOrOperation &) = delete;
+
+    NodeKind kind() const override { return NODE_LOGIC; }
+    BinaryOperator get_op() const { return op; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        for (size_t i = count; i != 0; i--) {
+            work.push_back(expand_node(operands[i - 1]));
+            if (i != 1) {
+                work.push_back(expand_text((op == OP_AND) ? " && " : " || "));
+            }
+        }
+    }
+
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
+
+    std::string signature() const override { return (op == OP_AND) ? "&&" : "||"; }
+    bool is_boolean() const override { return true; }
 
-    std::string to_string() const override {
-        const std::string opStr = (op == OP_AND) ? "&&" : "||";
-        return left->to_string() + " " + opStr + " " + right->to_string();
+    size_t child_count() const override { return count; }
+    const ASTNode *child(size_t index) const override { return operands[index]; }
+
+private:
+    BinaryOperator op;
+    ASTNode *pair[2];
+    std::vector<ASTNode *> many;
+    ASTNode *const *operands;
+    size_t count;
+};
+
+// 连续重复 b[*m:n]: 单独使用时表示 b 从当前时刻起连续成立 m 个周期,
+// 作为 ## 的左操作数时序列可以在第 m..n 个周期结束, 由 DelayControl 展开
+class Repetition : public ASTNode {
+public:
+    Repetition(ASTNode *operand, unsigned min, unsigned max) : operand(operand), min(min), max(max) {}
+
+    NodeKind kind() const override { return NODE_REPEAT; }
+    const ASTNode *get_operand() const { return operand; }
+    unsigned get_min() const { return min; }
+    // 原样返回, $ 为 UNBOUNDED
+    unsigned get_max() const { return max; }
+    // $ 按展开界取值, 至少为 min
+    unsigned get_max(unsigned horizon) const {
+        return max != UNBOUNDED ? max : std::max(min, unbounded_cycles(horizon));
+    }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        if (stage == 0) {
+            work.push_back(expand_node(this, 0, 1));
+            work.push_back(expand_node(operand));
+        } else {
+            out += signature();
+        }
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return (left->has_overlap() | right->has_overlap());
+    std::string signature() const override {
+        if (min == max) {
+            return "[*" + std::to_string(min) + "]";
+        }
+        return "[*" + std::to_string(min) + ":" + (max == UNBOUNDED ? "$" : std::to_string(max)) + "]";
     }
+    bool is_boolean() const override { return true; }
+
+    size_t child_count() const override { return 1; }
+    const ASTNode *child(size_t index) const override { return operand; }
+    unsigned child_span(size_t index, unsigned horizon) const override { return get_max(horizon); }
 
 private:
-    BinaryOperator op;
-    ASTNode* left;
-    ASTNode* right;
+    ASTNode *operand;
+    unsigned min;
+    unsigned max;
 };
 
-// 延时控制节点
+// 延时控制节点: l ##N r, 或区间 l ##[m:n] r. l 为 (可带括号的) 重复时按其各个结束周期展开
 class DelayControl : public ASTNode {
 public:
-    DelayControl(const unsigned& delay, ASTNode* left, ASTNode* right) : delay(delay), left(left), right(right) {}
-
-    std::string to_string() const override {
-        return left->to_string() + " ##" + std::to_string(delay) + " " + right->to_string();
+    DelayControl(const unsigned& delay, ASTNode* left, ASTNode* right) : delay(delay), max_delay(delay), left(left), right(right) {}
+    DelayControl(unsigned min, unsigned max, ASTNode *left, ASTNode *right)
+        : delay(min), max_delay(max), left(left), right(right) {}
+
+    NodeKind kind() const override { return NODE_DELAY; }
+    unsigned get_delay() const { return delay; }
+    // 原样返回, $ 为 UNBOUNDED
+    unsigned get_max_delay() const { return max_delay; }
+    // $ 按展开界取值, 至少为 get_delay()
+    unsigned get_max_delay(unsigned horizon) const {
+        unsigned cycles = unbounded_cycles(horizon);
+        return max_delay != UNBOUNDED ? max_delay : std::max(delay, cycles == 0 ? 0 : cycles - 1);
     }
+    bool is_range() const { return max_delay != delay; }
+    // 左操作数去掉括号后是重复时返回它
+    const Repetition *left_repetition() const;
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        if (stage == 0) {
+            work.push_back(expand_node(this, 0, 1));
+            work.push_back(expand_node(left));
+        } else {
+            out += " " + signature() + " ";
+            work.push_back(expand_node(right));
+        }
+    }
+
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    std::string to_smt_lib2(unsigned time) const override;
+    std::string signature() const override {
+        if (!is_range()) {
+            return "##" + std::to_string(delay);
+        }
+        return "##[" + std::to_string(delay) + ":" + (max_delay == UNBOUNDED ? "$" : std::to_string(max_delay)) + "]";
+    }
+    bool is_boolean() const override { return true; }
+
+    size_t child_count() const override { return 2; }
+    const ASTNode *child(size_t index) const override { return index == 0 ? left : right; }
+    // r 最早在左操作数最短的结束周期之后 m 个周期
+    unsigned child_time(size_t index, unsigned time) const override {
+        const Repetition *repetition = left_repetition();
+        unsigned first_end = repetition ? repetition->get_min() - 1 : 0;
+        return index == 0 ? time : time + (first_end + delay) * TIME_CLOCK;
+    }
+    unsigned child_span(size_t index, unsigned horizon) const override;
 
-    bool has_overlap() const override {
+    bool is_temporal() const override {
         return true;
     }
 
 private:
+    void emit_range(unsigned time, const Repetition *repetition, SmtEmitter &emitter) const;
+
     unsigned delay;
+    unsigned max_delay;
     ASTNode* left;
     ASTNode* right;
 };
@@ -236,15 +566,20 @@ class ParenExpression : public ASTNode {
 public:
     ParenExpression(ASTNode* expression) : expression(expression) {}
 
-    std::string to_string() const override {
-        return "(" + expression->to_string() + ")";
+    NodeKind kind() const override { return NODE_PAREN; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        out += "(";
+        work.push_back(expand_text(")"));
+        work.push_back(expand_node(expression));
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return expression->has_overlap();
-    }
+    std::string signature() const override { return "()"; }
+
+    size_t child_count() const override { return 1; }
+    const ASTNode *child(size_t index) const override { return expression; }
 
 private:
     ASTNode* expression;
@@ -254,13 +589,27 @@ class OverlapExpression : public ASTNode {
 public:
     OverlapExpression(ASTNode *left, ASTNode *right, bool delay) : left(left), right(right), delay(delay) {}
 
-    std::string to_string() const override {
-        return (left->to_string() + (delay ? "|=>" : "|->") + right->to_string());
+    NodeKind kind() const override { return NODE_OVERLAP; }
+    bool is_delayed() const { return delay; }
+
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        work.push_back(expand_node(right));
+        work.push_back(expand_text(delay ? "|=>" : "|->"));
+        work.push_back(expand_node(left));
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
+
+    std::string signature() const override { return delay ? "|=>" : "|->"; }
+    bool is_boolean() const override { return true; }
 
-    bool has_overlap() const override {
+    size_t child_count() const override { return 2; }
+    const ASTNode *child(size_t index) const override { return index == 0 ? left : right; }
+    unsigned child_time(size_t index, unsigned time) const override {
+        return (index == 1 && delay) ? time + TIME_CLOCK : time;
+    }
+
+    bool is_temporal() const override {
         return true;
     }
 
@@ -275,7 +624,10 @@ public:
     enum CompareType{EQUAL, NEQUAL, LEQUAL, GEQUAL, LESS, GREATER};
     CompareExpression(ASTNode *left, ASTNode *right, CompareType type) : left(left), right(right), type(type) {}
 
-    std::string get_type() const {
+    NodeKind kind() const override { return NODE_COMPARE; }
+    CompareType get_compare_type() const { return type; }
+
+    const char *get_type() const {
         switch (type)
         {
         case EQUAL:
@@ -296,15 +648,19 @@ public:
         return "";
     }
 
-    std::string to_string() const override {
-        return left->to_string() + get_type() + right->to_string();
+    void expand_string(unsigned stage, ExpandStack &work, std::string &out) const override {
+        work.push_back(expand_node(right));
+        work.push_back(expand_text(get_type()));
+        work.push_back(expand_node(left));
     }
 
-    std::string to_smt_lib2(unsigned time) const override;
+    void emit_smt_lib2(unsigned time, unsigned stage, SmtEmitter &emitter) const override;
 
-    bool has_overlap() const override {
-        return (left->has_overlap() | right->has_overlap());
-    }
+    std::string signature() const override { return get_type(); }
+    bool is_boolean() const override { return true; }
+
+    size_t child_count() const override { return 2; }
+    const ASTNode *child(size_t index) const override { return index == 0 ? left : right; }
 
 private:
     ASTNode *left;
@@ -312,10 +668,5 @@ private:
     CompareType type;
 };
 
-
-
-
-
-
-
-
+// 把 tokens 解析为 AST, 节点分配在 arena 中; tokens 指向的源文本只需在调用期间有效
+ASTNode *build_ast(const std::vector<Token> &tokens, AstArena &arena);
@@ -0,0 +1,246 @@
+#include "Server.h"
+#include "SVA2SMT.h"
+#include "ThreadPool.h"
+#include "Translator.h"
+#include "VerilogScanner.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct ServerOptions {
+    std::string socket_path;
+    SmtInformation info;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+};
+
+// 一个客户端: 读取请求的一端和写回复的一端, 回复整条加锁写出
+class Connection {
+public:
+    Connection(int input, int output, bool owned) : input(input), output(output), owned(owned) {}
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+    // 最后一个未完成的请求结束后才关闭
+    ~Connection() {
+        if (owned) {
+            close(input);
+            if (output != input) {
+                close(output);
+            }
+        }
+    }
+
+    bool read_line(std::string &line) {
+        for (;;) {
+            size_t end = received.find('\n');
+            if (end != std::string::npos) {
+                line = received.substr(0, end);
+                received.erase(0, end + 1);
+                return true;
+            }
+            char buffer[1 << 14];
+            ssize_t n = read(input, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                if (received.empty()) {
+                    return false;
+                }
+                line.swap(received);
+                received.clear();
+                return true;
+            }
+            received.append(buffer, static_cast<size_t>(n));
+        }
+    }
+
+    // 客户端断开时丢弃回复
+    void reply(const std::string &text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t done = 0;
+        while (done < text.size()) {
+            ssize_t n = write(output, text.data() + done, text.size() - done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return;
+            }
+            done += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int input;
+    int output;
+    bool owned;
+    std::string received;  // 只由读取线程访问
+    std::mutex mutex;
+};
+
+static std::vector<std::string> split_fields(const std::string &line) {
+    std::vector<std::string> fields;
+    size_t head = 0;
+    for (;;) {
+        size_t tab = line.find('\t', head);
+        fields.push_back(line.substr(head, tab == std::string::npos ? std::string::npos : tab - head));
+        if (tab == std::string::npos) {
+            break;
+        }
+        head = tab + 1;
+    }
+    if (!fields.empty() && !fields.back().empty() && fields.back().back() == '\r') {
+        fields.back().pop_back();
+    }
+    return fields;
+}
+
+// 处理一行请求, 返回 SMT 文本 (写到文件时为空) 和写出的字节数
+static size_t serve_request(const std::vector<std::string> &fields, const SmtInformation &defaults,
+                            std::string &smt) {
+    if (fields.size() < 5 || fields.size() > 6) {
+        throw std::runtime_error("expected: id source module time needfalse [output]");
+    }
+    SmtInformation info = defaults;
+    info.ModuleName = fields[2];
+    info.Time = atoi(fields[3].c_str());
+    info.NeedFalse = atoi(fields[4].c_str()) == 0;
+
+    std::unique_ptr<MappedFile> file;
+    std::string_view source;
+    const std::string &spec = fields[1];
+    if (spec.compare(0, 5, "file:") == 0) {
+        info.InputFileName = spec.substr(5);
+        file.reset(new MappedFile(info.InputFileName));
+        std::vector<AssertionSource> properties = scan_assert_properties(file->view());
+        if (properties.empty()) {
+            throw std::runtime_error("no assert property found in " + info.InputFileName);
+        }
+        source = properties.front().text;
+    } else if (spec.compare(0, 5, "text:") == 0) {
+        source = std::string_view(spec).substr(5);
+    } else {
+        throw std::runtime_error("source must start with file: or text:");
+    }
+
+    Translator translator(info);
+    translator.parse(source);
+    if (info.Simplify) {
+        translator.simplify();
+    }
+    if (fields.size() == 6 && !fields[5].empty()) {
+        std::ofstream out_file(fields[5], std::ios::binary);
+        if (!out_file) {
+            throw std::runtime_error("cannot open " + fields[5]);
+        }
+        StreamSink out(out_file);
+        translator.write(out);
+        out.flush();
+        return static_cast<size_t>(out_file.tellp());
+    }
+    StringSink out(smt);
+    translator.write(out);
+    return smt.size();
+}
+
+// 读取一个连接上的全部请求交给线程池; 连接由未完成的请求共同持有
+static void serve_connection(std::shared_ptr<Connection> connection, ThreadPool &pool, const SmtInformation &info) {
+    std::string line;
+    while (connection->read_line(line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        pool.submit([connection, &info, start, fields = split_fields(line)] {
+            std::string smt;
+            std::string header = fields[0] + "\t";
+            try {
+                size_t bytes = serve_request(fields, info, smt);
+                header += "ok\t";
+                header += std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start).count());
+                header += "\t" + std::to_string(bytes) + "\n";
+            } catch (const std::exception &error) {
+                smt.clear();
+                std::string message = error.what();
+                std::replace(message.begin(), message.end(), '\n', ' ');
+                header += "error\t";
+                header += std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start).count());
+                header += "\t" + message + "\n";
+            }
+            connection->reply(header + smt);
+        });
+    }
+}
+
+static bool read_server_options(int argc, char *argv[], ServerOptions &options) {
+    for (int i = 0; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = i + 1 < argc;
+        if (option == "--socket" && has_value) {
+            options.socket_path = argv[++i];
+        } else if (option == "--jobs" && has_value) {
+            options.jobs = std::max(1, atoi(argv[++i]));
+        } else if (option == "--share-terms") {
+            options.info.ShareTerms = true;
+        } else if (option == "--simplify") {
+            options.info.Simplify = true;
+        } else {
+            std::cerr << "unknown serve option: " << option << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int run_server(int argc, char *argv[]) {
+    ServerOptions options;
+    if (!read_server_options(argc, argv, options)) {
+        return 2;
+    }
+    // 客户端提前断开时 write 返回错误, 而不是结束服务进程
+    signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(options.jobs);
+
+    if (options.socket_path.empty()) {
+        serve_connection(std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false), pool, options.info);
+        return 0;  // pool 析构时等待剩余请求完成
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || options.socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "cannot create socket " << options.socket_path << std::endl;
+        return 1;
+    }
+    memcpy(address.sun_path, options.socket_path.c_str(), options.socket_path.size() + 1);
+    unlink(options.socket_path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        std::cerr << "cannot listen on " << options.socket_path << ": " << strerror(errno) << std::endl;
+        close(listener);
+        return 1;
+    }
+    std::cerr << "listening on " << options.socket_path << std::endl;
+    for (;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::cerr << "accept failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        std::thread(serve_connection, std::make_shared<Connection>(client, client, true),
+                    std::ref(pool), std::cref(options.info)).detach();
+    }
+    close(listener);
+    unlink(options.socket_path.c_str());
+    return 1;
+}
@@ -0,0 +1,20 @@
+//
+// 常驻服务模式: 进程只启动一次, 之后按行接收翻译请求, 在线程池上并发处理, 省去每次调用的启动开销.
+//
+// Using : SVA2SMT --serve [options]
+//   --socket PATH     listen on a Unix domain socket instead of stdin/stdout
+//   --jobs N          worker threads (default: hardware concurrency)
+//   --share-terms     see main.cpp
+//   --simplify        see main.cpp
+//
+// 请求为一行, 字段以 TAB 分隔:
+//   id  source  module  time  needfalse  [output]
+// source 为 file:PATH (取文件中第一个 assert property) 或 text:(ASSERTION).
+// 回复的第一行为
+//   id  ok  micros  bytes        给出 output 时 SMT 写到该路径, 否则紧跟 bytes 字节的 SMT 文本
+//   id  error  micros  message
+// 同一连接上的回复按完成顺序返回, 用 id 对应请求.
+//
+#pragma once
+
+int run_server(int argc, char *argv[]);
@@ -0,0 +1,286 @@
+#include "Simplify.h"
+#include <unordered_map>
+#include <unordered_set>
+
+static size_t count_nodes(const ASTNode *root) {
+    size_t count = 0;
+    std::vector<const ASTNode *> work{root};
+    while (!work.empty()) {
+        const ASTNode *node = work.back();
+        work.pop_back();
+        count++;
+        for (size_t i = 0; i < node->child_count(); i++) {
+            work.push_back(node->child(i));
+        }
+    }
+    return count;
+}
+
+static bool is_constant(const ASTNode *node, bool value) {
+    return node->kind() == NODE_BOOL_VALUE && static_cast<const BoolValue *>(node)->get_value() == value;
+}
+
+static bool is_logic(const ASTNode *node, BinaryOperator op) {
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    return node->kind() == NODE_LOGIC && static_cast<const LogicAndOrOperation *>(node)->get_op() == op;
+}
+
+// 待化简的子节点. &&/|| 链只在链顶处理一次: 穿过括号和同一运算的子链, 按从左到右收集整条链的操作数,
+// 链中间的节点不单独化简, 否则每一层都要复制子链展平后的操作数, 长链上是平方复杂度
+static std::vector<ASTNode *> operands_of(const ASTNode *node) {
+    std::vector<ASTNode *> operands;
+    if (node->kind() != NODE_LOGIC) {
+        for (size_t i = 0; i < node->child_count(); i++) {
+            // 节点都属于 arena, 遍历时去掉 child() 的 const
+            operands.push_back(const_cast<ASTNode *>(node->child(i)));
+        }
+        return operands;
+    }
+    const BinaryOperator op = static_cast<const LogicAndOrOperation *>(node)->get_op();
+    std::vector<const ASTNode *> work;
+    for (size_t i = node->child_count(); i != 0; i--) {
+        work.push_back(node->child(i - 1));
+    }
+    while (!work.empty()) {
+        const ASTNode *current = work.back();
+        work.pop_back();
+        if (!is_logic(current, op)) {
+            operands.push_back(const_cast<ASTNode *>(current));
+            continue;
+        }
+        for (size_t i = current->child_count(); i != 0; i--) {
+            work.push_back(current->child(i - 1));
+        }
+    }
+    return operands;
+}
+
+class Simplifier {
+public:
+    Simplifier(AstArena &arena, const SmtInformation &info) : arena(arena), info(info) {}
+
+    ASTNode *run(ASTNode *root);
+
+private:
+    ASTNode *rewrite(ASTNode *node, const std::vector<ASTNode *> &children);
+    ASTNode *rewrite_logic(LogicAndOrOperation *node, const std::vector<ASTNode *> &children);
+    ASTNode *rewrite_compare(CompareExpression *node, ASTNode *left, ASTNode *right);
+    ASTNode *rewrite_temporal(ASTNode *node, ASTNode *left, ASTNode *right);
+
+    ASTNode *constant(bool value) { return arena.make<BoolValue>(value); }
+    // 结构编号: 相同编号的子树在同一时刻展开结果相同
+    unsigned structure(const ASTNode *node);
+
+    // 节点自身的签名和子节点的结构编号
+    struct StructureKey {
+        std::string signature;
+        std::vector<unsigned> children;
+
+        bool operator==(const StructureKey &other) const {
+            return signature == other.signature && children == other.children;
+        }
+    };
+    struct StructureKeyHash {
+        size_t operator()(const StructureKey &key) const {
+            size_t hash = std::hash<std::string>()(key.signature);
+            for (unsigned child : key.children) {
+                hash = hash * 1000003 ^ child;
+            }
+            return hash;
+        }
+    };
+
+    AstArena &arena;
+    const SmtInformation &info;
+    std::unordered_map<StructureKey, unsigned, StructureKeyHash> unique;
+    std::unordered_map<const ASTNode *, unsigned> ids;
+};
+
+unsigned Simplifier::structure(const ASTNode *node) {
+    auto found = ids.find(node);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    // 子节点都已在后序遍历中编号
+    StructureKey key{node->signature(), {}};
+    key.children.reserve(node->child_count());
+    for (size_t i = 0; i < node->child_count(); i++) {
+        key.children.push_back(structure(node->child(i)));
+    }
+    unsigned id = unique.emplace(std::move(key), static_cast<unsigned>(unique.size())).first->second;
+    ids[node] = id;
+    return id;
+}
+
+ASTNode *Simplifier::run(ASTNode *root) {
+    // 后序遍历, 子节点的化简结果先于父节点得到
+    std::unordered_map<const ASTNode *, ASTNode *> result;
+    std::unordered_map<const ASTNode *, std::vector<ASTNode *>> operands;
+    std::vector<std::pair<ASTNode *, bool>> work{{root, false}};
+    while (!work.empty()) {
+        auto [node, visited] = work.back();
+        work.pop_back();
+        if (!visited) {
+            work.push_back({node, true});
+            for (ASTNode *operand : operands[node] = operands_of(node)) {
+                work.push_back({operand, false});
+            }
+            continue;
+        }
+        std::vector<ASTNode *> children;
+        for (ASTNode *operand : operands.at(node)) {
+            children.push_back(result.at(operand));
+        }
+        operands.erase(node);
+        ASTNode *rewritten = rewrite(node, children);
+        structure(rewritten);
+        result[node] = rewritten;
+    }
+    return result.at(root);
+}
+
+ASTNode *Simplifier::rewrite(ASTNode *node, const std::vector<ASTNode *> &children) {
+    switch (node->kind()) {
+        case NODE_PAREN:
+            return children[0];
+        case NODE_LOGIC:
+            return rewrite_logic(static_cast<LogicAndOrOperation *>(node), children);
+        case NODE_COMPARE:
+            return rewrite_compare(static_cast<CompareExpression *>(node), children[0], children[1]);
+        case NODE_DELAY:
+        case NODE_OVERLAP:
+            return rewrite_temporal(node, children[0], children[1]);
+        case NODE_REPEAT:
+            // false 重复仍是 false; true[*m:n] 作为 ## 的左操作数时结束周期可变, 保留
+            if (is_constant(children[0], false)) {
+                return children[0];
+            }
+            if (children[0] != node->child(0)) {
+                auto repetition = static_cast<Repetition *>(node);
+                return arena.make<Repetition>(children[0], repetition->get_min(), repetition->get_max());
+            }
+            return node;
+        default:
+            // 叶子和位选的子节点都是叶子, 不会改变
+            return node;
+    }
+}
+
+ASTNode *Simplifier::rewrite_logic(LogicAndOrOperation *node, const std::vector<ASTNode *> &children) {
+    const BinaryOperator op = node->get_op();
+    const bool identity = op == OP_AND;  // and 的单位元为 true, 零元为 false; or 相反
+
+    // 展平同一运算的子链, 去掉单位元, 遇到零元直接折叠
+    std::vector<ASTNode *> flat;
+    for (ASTNode *child : children) {
+        if (child->kind() == NODE_LOGIC && static_cast<LogicAndOrOperation *>(child)->get_op() == op) {
+            for (size_t i = 0; i < child->child_count(); i++) {
+                flat.push_back(const_cast<ASTNode *>(child->child(i)));
+            }
+        } else {
+            flat.push_back(child);
+        }
+    }
+    std::vector<ASTNode *> operands;
+    std::unordered_set<unsigned> seen;
+    for (ASTNode *operand : flat) {
+        if (is_constant(operand, !identity)) {
+            return constant(!identity);
+        }
+        if (is_constant(operand, identity) || !seen.insert(structure(operand)).second) {
+            continue;
+        }
+        operands.push_back(operand);
+    }
+
+    // 吸收律: x && (x || y) -> x, x || (x && y) -> x
+    std::vector<ASTNode *> kept;
+    for (ASTNode *operand : operands) {
+        bool absorbed = false;
+        if (operand->kind() == NODE_LOGIC) {
+            for (size_t i = 0; i < operand->child_count() && !absorbed; i++) {
+                absorbed = seen.count(structure(operand->child(i))) != 0;
+            }
+        }
+        if (!absorbed) {
+            kept.push_back(operand);
+        }
+    }
+
+    if (kept.empty()) {
+        return constant(identity);
+    }
+    if (kept.size() == 1) {
+        return kept[0];
+    }
+    if (kept.size() == 2 && node->child_count() == 2 && kept[0] == node->child(0) && kept[1] == node->child(1)) {
+        return node;
+    }
+    return arena.make<LogicAndOrOperation>(op, std::move(kept));
+}
+
+ASTNode *Simplifier::rewrite_compare(CompareExpression *node, ASTNode *left, ASTNode *right) {
+    const CompareExpression::CompareType type = node->get_compare_type();
+    int order = 0;  // left 与 right 的大小关系, 未知时不折叠
+    bool known = false;
+    if (structure(left) == structure(right)) {
+        known = true;
+    } else if (left->kind() == NODE_DATA_VALUE && right->kind() == NODE_DATA_VALUE) {
+        // 输出为 #b 字面量, 只有位数相同时比较才合法, 此时按字典序比较即按数值比较
+        const std::string &a = static_cast<const DataValue *>(left)->get_data();
+        const std::string &b = static_cast<const DataValue *>(right)->get_data();
+        if (a.size() == b.size()) {
+            known = true;
+            order = a.compare(b);
+        }
+    }
+    if (known) {
+        switch (type) {
+            case CompareExpression::EQUAL: return constant(order == 0);
+            case CompareExpression::NEQUAL: return constant(order != 0);
+            case CompareExpression::LEQUAL: return constant(order <= 0);
+            case CompareExpression::GEQUAL: return constant(order >= 0);
+            case CompareExpression::LESS: return constant(order < 0);
+            case CompareExpression::GREATER: return constant(order > 0);
+        }
+    }
+    if (left == node->child(0) && right == node->child(1)) {
+        return node;
+    }
+    return arena.make<CompareExpression>(left, right, type);
+}
+
+// ##N 和 |->/|=> 都展开为 (and l r'), NeedFalse 时 r' = (not r), 否则 r' = r.
+// ##[m:n] 和以重复开头的 ## 中 r' 是 r 在各时刻的析取 (再取反), r 为常量时同样折叠为该常量
+ASTNode *Simplifier::rewrite_temporal(ASTNode *node, ASTNode *left, ASTNode *right) {
+    if (is_constant(left, false)) {
+        return constant(false);
+    }
+    if (right->kind() == NODE_BOOL_VALUE && !info.DualPolarity) {
+        // 双极性模式下两种展开的折叠结果不同, 保留原样
+        bool value = static_cast<BoolValue *>(right)->get_value() != info.NeedFalse;
+        return value ? left : constant(false);
+    }
+    if (left == node->child(0) && right == node->child(1)) {
+        return node;
+    }
+    if (node->kind() == NODE_DELAY) {
+        auto delay = static_cast<DelayControl *>(node);
+        return arena.make<DelayControl>(delay->get_delay(), delay->get_max_delay(), left, right);
+    }
+    return arena.make<OverlapExpression>(left, right, static_cast<OverlapExpression *>(node)->is_delayed());
+}
+
+ASTNode *simplify(ASTNode *root, AstArena &arena, SmtInformation &info, SimplifyStats *stats) {
+    if (info.NegateRoot < 0) {
+        info.NegateRoot = (info.NeedFalse || info.DualPolarity) && !root->has_overlap();
+    }
+    ASTNode *result = Simplifier(arena, info).run(root);
+    if (stats) {
+        stats->nodes_before = count_nodes(root);
+        stats->nodes_after = count_nodes(result);
+    }
+    return result;
+}
@@ -0,0 +1,21 @@
+//
+// 输出前的 AST 化简:
+//   去掉括号节点; 两个同宽常量之间, 或两侧结构相同的比较折叠为布尔常量;
+//   同一运算的 &&/|| 链展平为 n 元 (and a b c); 常量吸收 (x && true -> x, x || true -> true);
+//   幂等 (x && x -> x); 吸收律 (x && (x || y) -> x); ##N 和 |->/|=> 按 NeedFalse 的展开方式折叠常量操作数
+//   (双极性模式下两种展开的结果不同, 不折叠常量右操作数).
+// 化简可能去掉所有时序算子, 因此先按化简前的 AST 固定根节点是否取反 (SmtInformation::NegateRoot).
+// 结果仍是一棵树, 新节点分配在同一个 AstArena 中.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+
+struct SimplifyStats {
+    size_t nodes_before = 0;
+    size_t nodes_after = 0;
+
+    size_t removed() const { return nodes_before - nodes_after; }
+};
+
+ASTNode *simplify(ASTNode *root, AstArena &arena, SmtInformation &info, SimplifyStats *stats = nullptr);
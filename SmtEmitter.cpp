@@ -0,0 +1,91 @@
+#include "SmtEmitter.h"
+#include <charconv>
+#include <cstring>
+
+SmtSink &SmtSink::operator<<(unsigned long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(digits, result.ptr - digits);
+    return *this;
+}
+
+void StreamSink::write(const char *data, size_t size) {
+    if (used + size > buffer.size()) {
+        flush();
+        if (size > buffer.size()) {
+            stream.write(data, size);
+            return;
+        }
+    }
+    memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void StreamSink::flush() {
+    if (used != 0) {
+        stream.write(buffer.data(), used);
+        used = 0;
+    }
+}
+
+void SmtEmitter::emit(const ASTNode *node, unsigned time) {
+    node->emit_smt_lib2(time, 0, *this);
+    while (!work.empty()) {
+        ExpandItem item = work.back();
+        work.pop_back();
+        if (!item.node) {
+            if (item.stage == POLARITY_BOTH) {
+                sink << item.text;
+            } else {
+                sink.write_polarity(item.text.data(), item.text.size(), item.stage);
+            }
+        } else if (item.stage != 0 || !substitute(item.node, item.time)) {
+            item.node->emit_smt_lib2(item.time, item.stage, *this);
+        }
+    }
+}
+
+// 名字 = 符号的前缀 "testbench.<module>_instance.<name>_" + 时刻的后缀 "<time>_1", 两段都按线程缓存,
+// 用到时才填. 符号编号只在一个符号表内有效, 换了符号表或模块名时清空前缀表.
+struct SignalNameTable {
+    static constexpr unsigned CACHED_TIMES = 1 << 16;  // 更大的时刻直接格式化
+
+    unsigned long long generation = 0;
+    std::string module;
+    std::vector<std::string> prefixes;  // 按符号编号, 空表示未填
+    std::vector<std::string> suffixes;  // 按时刻, 空表示未填
+};
+
+static thread_local SignalNameTable SignalNames;
+
+void SmtEmitter::write_signal(const Identifier &signal, unsigned time) {
+    SignalNameTable &table = SignalNames;
+    const SymbolTable &symbols = signal.get_symbols();
+    if (table.generation != symbols.generation() || table.module != info.ModuleName) {
+        table.generation = symbols.generation();
+        table.module = info.ModuleName;
+        table.prefixes.clear();
+    }
+    unsigned symbol = signal.get_symbol();
+    if (symbol >= table.prefixes.size()) {
+        table.prefixes.resize(symbols.size());
+    }
+    std::string &prefix = table.prefixes[symbol];
+    if (prefix.empty()) {
+        prefix = "testbench." + info.ModuleName + "_instance." + signal.get_name() + "_";
+    }
+    sink << prefix;
+
+    if (time >= SignalNameTable::CACHED_TIMES) {
+        sink << time << "_1";
+        return;
+    }
+    if (time >= table.suffixes.size()) {
+        table.suffixes.resize(std::max<size_t>(time + 1, table.suffixes.size() * 2));
+    }
+    std::string &suffix = table.suffixes[time];
+    if (suffix.empty()) {
+        suffix = std::to_string(time) + "_1";
+    }
+    sink << suffix;
+}
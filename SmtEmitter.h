@@ -0,0 +1,149 @@
+//
+// 流式 SMT-LIB2 输出: 节点把自己的文本直接写进 sink, 子节点压入工作栈, 不产生中间字符串.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include <ostream>
+
+// SMT 文本输出端
+class SmtSink {
+public:
+    virtual ~SmtSink() {}
+
+    virtual void write(const char *data, size_t size) = 0;
+    // 只属于 polarity 中极性的文本, 只在双极性模式下调用 (见 write_polarity), 由 DualSink 分派
+    virtual void write_polarity(const char *data, size_t size, unsigned polarity) { write(data, size); }
+    virtual void flush() {}
+
+    SmtSink &operator<<(std::string_view text) {
+        write(text.data(), text.size());
+        return *this;
+    }
+    SmtSink &operator<<(unsigned long long value);
+};
+
+// 追加到调用方的 std::string
+class StringSink : public SmtSink {
+public:
+    explicit StringSink(std::string &out) : out(out) {}
+
+    void write(const char *data, size_t size) override {
+        out.append(data, size);
+    }
+
+private:
+    std::string &out;
+};
+
+// 先写入缓冲区, 满了再整块写到 ostream
+class StreamSink : public SmtSink {
+public:
+    explicit StreamSink(std::ostream &stream, size_t capacity = 1 << 16)
+        : stream(stream), buffer(capacity), used(0) {}
+    ~StreamSink() override { flush(); }
+
+    void write(const char *data, size_t size) override;
+    void flush() override;
+
+private:
+    std::ostream &stream;
+    std::vector<char> buffer;
+    size_t used;
+};
+
+// 同时写到两个 sink, 例如输出文件和求解器进程
+class TeeSink : public SmtSink {
+public:
+    TeeSink(SmtSink &first, SmtSink &second) : first(first), second(second) {}
+
+    void write(const char *data, size_t size) override {
+        first.write(data, size);
+        second.write(data, size);
+    }
+    void flush() override {
+        first.flush();
+        second.flush();
+    }
+
+private:
+    SmtSink &first;
+    SmtSink &second;
+};
+
+// 双极性输出: 共有的文本写到两边, 只属于一种极性的文本只写到对应的一边
+class DualSink : public SmtSink {
+public:
+    DualSink(SmtSink &negative, SmtSink &positive) : negative(negative), positive(positive) {}
+
+    void write(const char *data, size_t size) override {
+        negative.write(data, size);
+        positive.write(data, size);
+    }
+    void write_polarity(const char *data, size_t size, unsigned polarity) override {
+        if (polarity & POLARITY_NEGATIVE) {
+            negative.write(data, size);
+        }
+        if (polarity & POLARITY_POSITIVE) {
+            positive.write(data, size);
+        }
+    }
+    void flush() override {
+        negative.flush();
+        positive.flush();
+    }
+
+private:
+    SmtSink &negative;
+    SmtSink &positive;
+};
+
+// 写出只属于 polarity 中极性的文本: 双极性模式下交给 sink 分派, 否则只在与 NeedFalse 相符时写出
+inline void write_polarity(SmtSink &out, const SmtInformation &info, std::string_view text, unsigned polarity) {
+    if (info.DualPolarity) {
+        if (polarity != 0) {
+            out.write_polarity(text.data(), text.size(), polarity);
+        }
+    } else if (polarity & output_polarity(info)) {
+        out << text;
+    }
+}
+
+class SmtEmitter {
+public:
+    SmtEmitter(SmtSink &sink, const SmtInformation &info) : sink(sink), info(info) {}
+    virtual ~SmtEmitter() {}
+
+    // 把 node 在 time 时刻的完整展开写入 sink
+    void emit(const ASTNode *node, unsigned time);
+
+    // 以下供节点的 emit_smt_lib2 调用
+    void write(std::string_view text) { sink << text; }
+    void write(unsigned long long value) { sink << value; }
+    // 与 GET_DECLARE_NAME 相同的名字, 取自按线程缓存的 (符号, 时刻) 名字表
+    void write_signal(const Identifier &signal, unsigned time);
+    void push(std::string_view text) { work.push_back(expand_text(text)); }
+    // 只属于一种极性的文本, 单极性输出时不相符的直接丢弃
+    void push(std::string_view text, Polarity polarity) {
+        if (info.DualPolarity) {
+            work.push_back(expand_text(text, polarity));
+        } else if (polarity & output_polarity(info)) {
+            work.push_back(expand_text(text));
+        }
+    }
+    void push(const ASTNode *node, unsigned time, unsigned stage = 0) {
+        work.push_back(expand_node(node, time, stage));
+    }
+
+    const SmtInformation &options() const { return info; }
+    SmtSink &output() { return sink; }
+
+protected:
+    // 子节点展开前的钩子, 返回 true 表示已由子类输出 (例如共享子项的名字)
+    virtual bool substitute(const ASTNode *node, unsigned time) { return false; }
+
+private:
+    SmtSink &sink;
+    const SmtInformation &info;
+    ExpandStack work;
+};
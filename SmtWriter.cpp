@@ -0,0 +1,380 @@
+#include "SmtWriter.h"
+#include "Parametric.h"
+#include "Profiler.h"
+#include "Solver.h"
+#include "SortInference.h"
+#include "TermSharing.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <fstream>
+#include <set>
+
+// 是否有子节点在多个时刻展开 (##[m:n], [*m:n]). 这时逐层内联会随嵌套指数增长, 必须共享子项
+static bool has_ranges(const ASTNode *root, unsigned horizon) {
+    std::vector<const ASTNode *> work{root};
+    while (!work.empty()) {
+        const ASTNode *node = work.back();
+        work.pop_back();
+        for (size_t i = 0; i < node->child_count(); i++) {
+            if (node->child_span(i, horizon) > 1) {
+                return true;
+            }
+            work.push_back(node->child(i));
+        }
+    }
+    return false;
+}
+
+// 是否有区间延时 (##[m:n], 或左操作数为 [*m:n] 的 ##N): r 要在一个窗口的多个时刻展开.
+// 固定的延时和重复只在确定的偏移上展开, --parametric 可以表示
+static bool has_windows(const ASTNode *root, unsigned horizon) {
+    std::vector<const ASTNode *> work{root};
+    while (!work.empty()) {
+        const ASTNode *node = work.back();
+        work.pop_back();
+        if (node->kind() == NODE_DELAY && node->child_span(1, horizon) > 1) {
+            return true;
+        }
+        for (size_t i = 0; i < node->child_count(); i++) {
+            work.push_back(node->child(i));
+        }
+    }
+    return false;
+}
+
+// 根节点取反的极性. 双极性模式下只有 NeedFalse 的一侧可能取反, 化简也按这一侧固定 NegateRoot
+static unsigned negated_polarity(const ASTNode *root, const SmtInformation &info) {
+    if (info.DualPolarity) {
+        bool negate = info.NegateRoot >= 0 ? info.NegateRoot != 0 : !root->has_overlap();
+        return negate ? POLARITY_NEGATIVE : 0;
+    }
+    bool negate = info.NegateRoot >= 0 ? info.NegateRoot != 0 : info.NeedFalse && !root->has_overlap();
+    return negate ? output_polarity(info) : 0;
+}
+
+Unroller::Unroller(const ASTNode *root, const SmtInformation &info)
+    : root(root), info(info), negated(negated_polarity(root, info)) {
+    ProfileScope scope("prepare");
+    bool ranges = has_ranges(root, info.Time);
+    bool windows = has_windows(root, info.Time);
+    if (info.Parametric && windows) {
+        // Property 体按 child_time 逐个展开子节点, 不展开窗口
+        std::cerr << "--parametric does not support delay ranges, sharing terms instead" << std::endl;
+    }
+    if (info.Parametric && !windows) {
+        parametric.reset(new ParametricProperty(root, info));
+    } else if (info.ShareTerms || ranges) {
+        shared.reset(new SharedTerms(root, info));
+    }
+}
+
+Unroller::~Unroller() {}
+
+// 每个用到的 (信号, 时刻) 一个 declare-const, 按信号首次出现的顺序, 时刻升序.
+// 推断不出 sort 的信号不声明, 需要由 --sort 或 --prelude 给出
+static void write_declarations(const ASTNode *root, const SmtInformation &info, const std::vector<unsigned> &steps,
+                               SmtSink &out) {
+    std::map<unsigned, std::pair<const Identifier *, std::set<unsigned>>> uses;  // 符号 -> (一处出现, 时刻偏移)
+    std::set<std::pair<const ASTNode *, unsigned>> seen;
+    std::vector<std::pair<const ASTNode *, unsigned>> work{{root, 0}};
+    while (!work.empty()) {
+        auto [node, offset] = work.back();
+        work.pop_back();
+        if (!seen.insert({node, offset}).second) {
+            continue;
+        }
+        if (node->kind() == NODE_IDENTIFIER) {
+            auto identifier = static_cast<const Identifier *>(node);
+            auto &entry = uses[identifier->get_symbol()];
+            entry.first = identifier;
+            entry.second.insert(offset);
+        }
+        for (size_t i = 0; i < node->child_count(); i++) {
+            for (unsigned k = 0, span = node->child_span(i, info.Time); k < span; k++) {
+                work.push_back({node->child(i), node->child_time(i, offset) + k * TIME_CLOCK});
+            }
+        }
+    }
+    std::map<std::string, std::string> sorts = infer_signal_sorts(root, info);
+    SmtEmitter emitter(out, info);
+    for (const auto &[symbol, entry] : uses) {
+        const Identifier *identifier = entry.first;
+        auto sort = sorts.find(identifier->get_name());
+        if (sort == sorts.end()) {
+            std::cerr << "cannot infer the sort of " << identifier->get_name() << ", not declared" << std::endl;
+            continue;
+        }
+        std::vector<unsigned> times;
+        for (unsigned step : steps) {
+            for (unsigned offset : entry.second) {
+                times.push_back(step + offset);
+            }
+        }
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+        for (unsigned time : times) {
+            out << "(declare-const ";
+            emitter.write_signal(*identifier, time);
+            out << " " << sort->second << ")\n";
+        }
+    }
+}
+
+// 1, 3, ... 直到 Time 之前的所有奇数步
+static std::vector<unsigned> all_steps(const SmtInformation &info) {
+    std::vector<unsigned> steps;
+    for (unsigned i = 1; i < info.Time; i+=2) {
+        steps.push_back(i);
+    }
+    return steps;
+}
+
+void Unroller::write_prologue(SmtSink &out) const {
+    write_prologue(out, info.Declare ? all_steps(info) : std::vector<unsigned>());
+}
+
+void Unroller::write_prologue(SmtSink &out, const std::vector<unsigned> &steps) const {
+    ProfileScope scope("prologue");
+    if (!info.PreludeFile.empty()) {
+        std::ifstream prelude(info.PreludeFile, std::ios::binary);
+        if (!prelude) {
+            throw std::runtime_error("cannot open prelude " + info.PreludeFile);
+        }
+        char buffer[1 << 14];
+        while (prelude.read(buffer, sizeof(buffer)) || prelude.gcount() != 0) {
+            out.write(buffer, prelude.gcount());
+        }
+    }
+    if (info.Declare) {
+        write_declarations(root, info, steps, out);
+    }
+    if (parametric) {
+        parametric->define(out);
+    }
+}
+
+void Unroller::write_step(SmtSink &out, unsigned step) const {
+    write_step(out, step, nullptr);
+}
+
+void Unroller::write_step(SmtSink &out, unsigned step, std::unordered_set<uint64_t> *defined) const {
+    ProfileScope scope("step", step);
+    if (shared) {
+        shared->define(step, out, defined);
+    }
+    out << "(declare-const Assert_" << step << " Bool)\n";
+    out << "(assert (= Assert_" << step;
+    write_polarity(out, info, " (not ", negated);
+    write_polarity(out, info, " ", POLARITY_BOTH & ~negated);
+    if (parametric) {
+        parametric->apply(step, out);
+    } else if (shared) {
+        shared->reference(step, out);
+    } else {
+        SmtEmitter emitter(out, info);
+        emitter.emit(root, step);
+    }
+    write_polarity(out, info, ")", negated);
+    out << "))\n";
+    if (info.Incremental) {
+        out << "(push 1)\n(assert Assert_" << step << ")\n(check-sat)\n(pop 1)\n";
+    }
+}
+
+void Unroller::write_steps(SmtSink &out, unsigned first, unsigned last) const {
+    for (unsigned i = first; i < last; i+=2) {
+        write_step(out, i);
+    }
+}
+
+void Unroller::write_epilogue(SmtSink &out) const {
+    write_epilogue(out, all_steps(info));
+}
+
+void Unroller::write_epilogue(SmtSink &out, const std::vector<unsigned> &steps) const {
+    if (info.Incremental) {
+        return;
+    }
+    out << "(assert (= true (or";
+    for (unsigned i : steps) {
+        out << " Assert_" << i;
+    }
+    out << ")))\n";
+}
+
+void Unroller::write_shard(SmtSink &out, const std::vector<unsigned> &steps) const {
+    write_prologue(out, info.Declare ? steps : std::vector<unsigned>());
+    // 共享子项的定义者可能在别的分片里, 这里按本文件已写出的重新判断
+    std::unordered_set<uint64_t> defined;
+    for (unsigned step : steps) {
+        write_step(out, step, &defined);
+    }
+    write_epilogue(out, steps);
+}
+
+// 把各步切成块, 在线程池上分别渲染到各自的缓冲区, 再按顺序写出; 与单线程输出逐字节相同.
+// 双极性模式下每块渲染为两份, 分别写到对应的一侧
+static void write_steps_parallel(SmtSink &out, const Unroller &unroller) {
+    const SmtInformation &info = unroller.options();
+    struct Chunk {
+        std::string text;
+        std::string positive;  // 双极性模式下 POLARITY_POSITIVE 一侧, text 为另一侧
+        std::exception_ptr error;  // 渲染失败时在主线程写到这一块时重新抛出
+        bool done = false;
+    };
+    const unsigned steps = info.Time / 2;
+    const unsigned chunk_steps = std::max(64u, steps / (info.Jobs * 16));
+    const size_t count = (steps + chunk_steps - 1) / chunk_steps;
+    const size_t window = info.Jobs * 4;  // 同时在途的块数, 限制内存占用
+
+    std::vector<Chunk> chunks(count);
+    std::mutex mutex;
+    std::condition_variable finished;
+    ThreadPool pool(info.Jobs);
+    auto submit = [&](size_t k) {
+        pool.submit([&, k] {
+            unsigned first = 1 + 2 * chunk_steps * k;
+            unsigned last = std::min(info.Time, first + 2 * chunk_steps);
+            std::string text, positive;
+            std::exception_ptr error = invoke_task([&] {
+                StringSink sink(text), positive_sink(positive);
+                if (info.DualPolarity) {
+                    DualSink dual(sink, positive_sink);
+                    unroller.write_steps(dual, first, last);
+                } else {
+                    unroller.write_steps(sink, first, last);
+                }
+            });
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks[k].text = std::move(text);
+            chunks[k].positive = std::move(positive);
+            chunks[k].error = error;
+            chunks[k].done = true;
+            finished.notify_all();
+        });
+    };
+
+    size_t submitted = 0;
+    while (submitted < std::min(count, window)) {
+        submit(submitted++);
+    }
+    for (size_t k = 0; k < count; k++) {
+        std::string text, positive;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return chunks[k].done; });
+            if (chunks[k].error) {
+                std::rethrow_exception(chunks[k].error);
+            }
+            text = std::move(chunks[k].text);
+            positive = std::move(chunks[k].positive);
+        }
+        if (info.DualPolarity) {
+            out.write_polarity(text.data(), text.size(), POLARITY_NEGATIVE);
+            out.write_polarity(positive.data(), positive.size(), POLARITY_POSITIVE);
+        } else {
+            out << text;
+        }
+        if (submitted < count) {
+            submit(submitted++);
+        }
+    }
+}
+
+void write_smt_lib2(const ASTNode *root, const SmtInformation &info, SmtSink &out) {
+    Unroller unroller(root, info);
+    unroller.write_prologue(out);
+    if (info.Jobs > 1) {
+        write_steps_parallel(out, unroller);
+    } else {
+        unroller.write_steps(out, 1, info.Time);
+    }
+    unroller.write_epilogue(out);
+}
+
+// 文件名中扩展名开始的位置, 没有扩展名时为末尾
+static size_t extension_at(const std::string &path) {
+    size_t slash = path.rfind('/');
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+    size_t dot = path.rfind('.');
+    return dot == std::string::npos || dot <= start ? path.size() : dot;
+}
+
+static std::string base_name(const std::string &path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string write_shards(const ASTNode *root, const SmtInformation &info) {
+    // 连续的区间让相邻步共用的共享子项和声明留在同一个文件里
+    std::vector<unsigned> steps = all_steps(info);
+    const size_t count = std::max<size_t>(1, std::min<size_t>(info.Shards, steps.size()));
+    std::vector<std::vector<unsigned>> shards(count);
+    for (size_t k = 0, next = 0; k < count; k++) {
+        size_t size = steps.size() / count + (k < steps.size() % count ? 1 : 0);
+        shards[k].assign(steps.begin() + next, steps.begin() + next + size);
+        next += size;
+    }
+
+    Unroller unroller(root, info);
+    const size_t extension = extension_at(info.OutputFileName);
+    std::vector<std::string> files(count);
+    {
+        ThreadPool pool(std::min<unsigned>(info.Jobs, static_cast<unsigned>(count)));
+        for (size_t k = 0; k < count; k++) {
+            files[k] = info.OutputFileName.substr(0, extension) + ".shard" + std::to_string(k)
+                     + info.OutputFileName.substr(extension);
+            pool.submit([&, k] {
+                std::ofstream file(files[k]);
+                StreamSink out(file);
+                unroller.write_shard(out, shards[k]);
+                out.flush();
+                if (!file) {
+                    throw std::runtime_error("cannot write " + files[k]);
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    std::string manifest_name = info.OutputFileName.substr(0, extension) + ".manifest.json";
+    std::ofstream manifest(manifest_name);
+    manifest << "{\n  \"time\": " << info.Time << ",\n  \"shards\": [";
+    for (size_t k = 0; k < count; k++) {
+        manifest << (k ? ",\n" : "\n") << "    {\"file\": \"" << base_name(files[k]) << "\", \"steps\": [";
+        for (size_t i = 0; i < shards[k].size(); i++) {
+            manifest << (i ? ", " : "") << shards[k][i];
+        }
+        manifest << "]}";
+    }
+    manifest << "\n  ]\n}\n";
+    if (!manifest) {
+        throw std::runtime_error("cannot write " + manifest_name);
+    }
+    return manifest_name;
+}
+
+unsigned check_incremental(const ASTNode *root, const SmtInformation &info, SmtSink &script, SolverProcess &solver) {
+    Unroller unroller(root, info);
+    TeeSink out(script, solver);
+    unroller.write_prologue(out);
+    for (unsigned i = 1; i < info.Time; i+=2) {
+        unroller.write_step(out, i);
+        out.flush();
+        // 求解器对 declare/define/assert 不输出, 只对 check-sat 输出一行; error 行原样报告
+        std::string line;
+        do {
+            if (!solver.read_line(line)) {
+                throw std::runtime_error("solver exited before answering bound " + std::to_string(i));
+            }
+        } while (line.empty());
+        std::cout << "bound " << i << ": " << line << std::endl;
+        if (line == "sat") {
+            return i;
+        }
+        if (line != "unsat" && line != "unknown") {
+            throw std::runtime_error("solver error at bound " + std::to_string(i) + ": " + line);
+        }
+    }
+    return 0;
+}
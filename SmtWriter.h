@@ -0,0 +1,58 @@
+//
+// 按 Time 展开断言: 每个奇数步一个 Assert_i, 最后断言它们的析取.
+// 增量模式下每一步之后改为 (push 1) (assert Assert_i) (check-sat) (pop 1).
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include "SmtEmitter.h"
+#include <unordered_set>
+
+class SharedTerms;
+class ParametricProperty;
+class SolverProcess;
+
+// 展开一个断言所需的只读状态, 各步可以在不同线程上同时输出
+class Unroller {
+public:
+    Unroller(const ASTNode *root, const SmtInformation &info);
+    ~Unroller();
+
+    // 前导部分: --prelude 文件内容, 参数化模式下的 Property 定义
+    void write_prologue(SmtSink &out) const;
+    // 第 step 步 (奇数) 的定义, Assert_step 的声明和约束, 增量模式下的 check-sat
+    void write_step(SmtSink &out, unsigned step) const;
+    // [first, last) 中的所有奇数步
+    void write_steps(SmtSink &out, unsigned first, unsigned last) const;
+    // 非增量模式下的 (assert (= true (or Assert_1 ...)))
+    void write_epilogue(SmtSink &out) const;
+    // 只含 steps 中各步的独立脚本: 自带声明和共享子项定义, 以这些步的析取结尾
+    void write_shard(SmtSink &out, const std::vector<unsigned> &steps) const;
+
+    const SmtInformation &options() const { return info; }
+
+private:
+    void write_prologue(SmtSink &out, const std::vector<unsigned> &steps) const;
+    void write_step(SmtSink &out, unsigned step, std::unordered_set<uint64_t> *defined) const;
+    void write_epilogue(SmtSink &out, const std::vector<unsigned> &steps) const;
+
+    const ASTNode *root;
+    const SmtInformation &info;
+    std::unique_ptr<SharedTerms> shared;
+    std::unique_ptr<ParametricProperty> parametric;
+    unsigned negated;  // 根节点取反的极性 (Polarity), 0 表示都不取反
+};
+
+// 把 root 按 info 展开写入 out; info.Jobs > 1 时在线程池上渲染, 输出与单线程相同.
+// info.DualPolarity 时 out 须为 DualSink, 两种极性在同一次展开中写出, 共享子项各只渲染一次
+void write_smt_lib2(const ASTNode *root, const SmtInformation &info, SmtSink &out);
+
+// 分片模式: 把各奇数步按顺序分成 info.Shards 段连续的区间, 每段写成一个独立的 SMT-LIB2 文件
+// (out.smt2 -> out.shard0.smt2, ...), 可以交给多个求解器进程同时求解, 任何一个 sat 即为反例.
+// 另写一个 JSON 清单 out.manifest.json 记录各文件包含的步. info.Jobs 个线程同时写各分片.
+// 返回清单的文件名
+std::string write_shards(const ASTNode *root, const SmtInformation &info);
+
+// 增量模式: 逐步写出脚本并送入 solver, 每个 check-sat 之后读取结果, 第一次 sat 时停止.
+// 写入 script 的内容与 write_smt_lib2 相同 (截止到停止的那一步). 返回 sat 的步, 没有时返回 0
+unsigned check_incremental(const ASTNode *root, const SmtInformation &info, SmtSink &script, SolverProcess &solver);
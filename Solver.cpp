@@ -0,0 +1,154 @@
+#include "Solver.h"
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 写管道时在当前线程屏蔽 SIGPIPE, 求解器提前退出时 write 返回 EPIPE 而不是结束整个进程.
+// 只改本线程的信号掩码, 不改进程的信号处理方式; 写入产生的 SIGPIPE 在恢复掩码前取走
+static ssize_t write_without_sigpipe(int fd, const char *data, size_t size) {
+    sigset_t sigpipe, saved, already;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &saved);
+    sigpending(&already);
+    ssize_t n = ::write(fd, data, size);
+    int error = errno;
+    if (n < 0 && error == EPIPE && !sigismember(&already, SIGPIPE)) {
+        timespec zero = {0, 0};
+        while (sigtimedwait(&sigpipe, nullptr, &zero) < 0 && errno == EINTR) {
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+    errno = error;
+    return n;
+}
+
+SolverProcess::SolverProcess(const std::string &command) {
+    int to_child[2];
+    int from_child[2];
+    if (pipe(to_child) != 0) {
+        throw std::runtime_error("cannot create pipe for solver");
+    }
+    if (pipe(from_child) != 0) {
+        close(to_child[0]);
+        close(to_child[1]);
+        throw std::runtime_error("cannot create pipe for solver");
+    }
+    pid = fork();
+    if (pid < 0) {
+        close(to_child[0]);
+        close(to_child[1]);
+        close(from_child[0]);
+        close(from_child[1]);
+        throw std::runtime_error("cannot fork solver");
+    }
+    if (pid == 0) {
+        dup2(to_child[0], STDIN_FILENO);
+        dup2(from_child[1], STDOUT_FILENO);
+        close(to_child[0]);
+        close(to_child[1]);
+        close(from_child[0]);
+        close(from_child[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    close(to_child[0]);
+    close(from_child[1]);
+    input = to_child[1];
+    output = from_child[0];
+    // 写入不阻塞, flush 才能在管道满时转去读求解器的输出
+    fcntl(input, F_SETFL, fcntl(input, F_GETFL) | O_NONBLOCK);
+}
+
+SolverProcess::~SolverProcess() {
+    try {
+        flush();
+    } catch (const std::runtime_error &) {
+    }
+    if (input >= 0) {
+        close(input);
+    }
+    if (output >= 0) {
+        close(output);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+}
+
+void SolverProcess::write(const char *data, size_t size) {
+    pending.append(data, size);
+    if (pending.size() >= (1 << 16)) {
+        flush();
+    }
+}
+
+// 求解器的输出管道满时它会停下等我们读, 所以写脚本的同时把已有的输出读进 received, 否则双方互相等待
+void SolverProcess::flush() {
+    size_t done = 0;
+    bool readable = true;
+    while (done < pending.size()) {
+        pollfd fds[2] = {{input, POLLOUT, 0}, {readable ? output : -1, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            pending.clear();
+            throw std::runtime_error("cannot poll solver");
+        }
+        if (fds[1].revents != 0) {
+            readable = receive();
+        }
+        if (fds[0].revents == 0) {
+            continue;
+        }
+        ssize_t n = write_without_sigpipe(input, pending.data() + done, pending.size() - done);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            pending.clear();
+            throw std::runtime_error("solver closed its input");
+        }
+        done += static_cast<size_t>(n);
+    }
+    pending.clear();
+}
+
+bool SolverProcess::receive() {
+    char buffer[4096];
+    ssize_t n;
+    do {
+        n = read(output, buffer, sizeof(buffer));
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    received.append(buffer, static_cast<size_t>(n));
+    return true;
+}
+
+bool SolverProcess::read_line(std::string &line) {
+    for (;;) {
+        size_t end = received.find('\n');
+        if (end != std::string::npos) {
+            line = received.substr(0, end);
+            received.erase(0, end + 1);
+            return true;
+        }
+        if (!receive()) {
+            if (received.empty()) {
+                return false;
+            }
+            line.swap(received);
+            received.clear();
+            return true;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+//
+// 以子进程运行 SMT 求解器 (如 "z3 -in", "cvc5 --incremental"), 通过管道写入脚本并逐行读取结果.
+// 不改变进程的 SIGPIPE 处理方式: 写管道时只在当前线程屏蔽该信号.
+//
+#pragma once
+
+#include "SmtEmitter.h"
+#include <string>
+#include <sys/types.h>
+
+class SolverProcess : public SmtSink {
+public:
+    // 用 /bin/sh -c command 启动求解器, 失败时抛出 std::runtime_error
+    explicit SolverProcess(const std::string &command);
+    SolverProcess(const SolverProcess &) = delete;
+    SolverProcess &operator=(const SolverProcess &) = delete;
+    // 关闭求解器的标准输入并等待其退出
+    ~SolverProcess() override;
+
+    void write(const char *data, size_t size) override;
+    void flush() override;
+
+    // 读一行输出 (不含换行), 求解器已退出时返回 false
+    bool read_line(std::string &line);
+
+private:
+    // 读一次求解器的输出追加到 received, 输出已关闭时返回 false
+    bool receive();
+
+    pid_t pid = -1;
+    int input = -1;   // 求解器的标准输入
+    int output = -1;  // 求解器的标准输出
+    std::string pending;
+    std::string received;
+};
@@ -0,0 +1,102 @@
+#include "SortInference.h"
+
+std::string bitvec_sort(unsigned width) {
+    return "(_ BitVec " + std::to_string(width) + ")";
+}
+
+std::string value_sort(const ASTNode *node, const SmtInformation &info) {
+    while (node->kind() == NODE_PAREN) {
+        node = node->child(0);
+    }
+    switch (node->kind()) {
+        case NODE_DATA_VALUE:
+            // 输出为 #b 字面量, 位数是数据的位数而不是声明的位宽 (8'b1 输出为 #b1)
+            return bitvec_sort(static_cast<unsigned>(static_cast<const DataValue *>(node)->get_data().size()));
+        case NODE_BIT_SELECT:
+            return bitvec_sort(1);
+        case NODE_RANGE_SELECT: {
+            auto select = static_cast<const RangeSelect *>(node);
+            return bitvec_sort(select->get_msb() - select->get_lsb() + 1);
+        }
+        case NODE_IDENTIFIER: {
+            auto it = info.SignalSorts.find(static_cast<const Identifier *>(node)->get_name());
+            return it == info.SignalSorts.end() ? "" : it->second;
+        }
+        default:
+            return "Bool";
+    }
+}
+
+unsigned sort_width(const std::string &sort) {
+    if (sort == "Bool") {
+        return 1;
+    }
+    if (sort.compare(0, 10, "(_ BitVec ") == 0) {
+        return static_cast<unsigned>(atoi(sort.c_str() + 10));
+    }
+    return 0;
+}
+
+std::map<std::string, std::string> infer_signal_sorts(const ASTNode *root, const SmtInformation &info) {
+    std::map<std::string, std::string> sorts;
+    std::map<std::string, unsigned> select_bound;  // 只在位选中出现的信号的位宽下界
+    struct Frame {
+        const ASTNode *node;
+        std::string sort;  // 上下文要求的 sort, 空表示未知
+    };
+    std::vector<Frame> work{{root, "Bool"}};
+    while (!work.empty()) {
+        Frame frame = work.back();
+        work.pop_back();
+        const ASTNode *node = frame.node;
+        switch (node->kind()) {
+            case NODE_PAREN:
+                work.push_back({node->child(0), frame.sort});
+                break;
+            case NODE_LOGIC:
+            case NODE_DELAY:
+            case NODE_OVERLAP:
+            case NODE_REPEAT:
+                for (size_t i = node->child_count(); i != 0; i--) {
+                    work.push_back({node->child(i - 1), "Bool"});
+                }
+                break;
+            case NODE_IDENTIFIER: {
+                const std::string &name = static_cast<const Identifier *>(node)->get_name();
+                auto given = info.SignalSorts.find(name);
+                if (given != info.SignalSorts.end()) {
+                    sorts[name] = given->second;
+                } else if (!frame.sort.empty()) {
+                    sorts.emplace(name, frame.sort);
+                }
+                break;
+            }
+            case NODE_BIT_SELECT:
+            case NODE_RANGE_SELECT: {
+                auto variable = static_cast<const Identifier *>(node->child(0));
+                unsigned msb = node->kind() == NODE_BIT_SELECT
+                                   ? static_cast<const BitSelect *>(node)->get_bit()
+                                   : static_cast<const RangeSelect *>(node)->get_msb();
+                unsigned &bound = select_bound[variable->get_name()];
+                bound = std::max(bound, msb + 1);
+                break;
+            }
+            case NODE_COMPARE: {
+                std::string sort = value_sort(node->child(0), info);
+                if (sort.empty()) {
+                    sort = value_sort(node->child(1), info);
+                }
+                work.push_back({node->child(1), sort});
+                work.push_back({node->child(0), sort});
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    for (const auto &[name, width] : select_bound) {
+        auto given = info.SignalSorts.find(name);
+        sorts.emplace(name, given != info.SignalSorts.end() ? given->second : bitvec_sort(width));
+    }
+    return sorts;
+}
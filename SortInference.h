@@ -0,0 +1,19 @@
+//
+// 推断断言中各信号的 sort, 用于输出 declare-const 和位级后端.
+// 优先级: SmtInformation::SignalSorts 给定的 > 上下文推断的 (Bool 运算的操作数为 Bool,
+// 与常量或位选比较时取对方的位宽) > 位选给出的下界 (name[7:0] 说明至少 8 位).
+// 无法推断的信号不出现在结果中.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+
+std::map<std::string, std::string> infer_signal_sorts(const ASTNode *root, const SmtInformation &info);
+
+// "(_ BitVec n)" 的位宽, Bool 为 1, 其他 sort 为 0
+unsigned sort_width(const std::string &sort);
+
+std::string bitvec_sort(unsigned width);
+
+// 值上下文中 node 输出后的 sort (常量按输出的字面量), 信号的 sort 未在 info.SignalSorts 中给出时为空
+std::string value_sort(const ASTNode *node, const SmtInformation &info);
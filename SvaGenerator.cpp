@@ -0,0 +1,156 @@
+#include "SvaGenerator.h"
+
+static const char *const SHAPE_NAMES[] = {
+    "and_chain", "or_chain", "delay_chain", "range_select", "huge_delay", "nested", "delay_range", "random",
+};
+
+const char *shape_name(AssertionShape shape) {
+    return SHAPE_NAMES[shape];
+}
+
+bool parse_shape(const std::string &name, AssertionShape &shape) {
+    for (AssertionShape candidate : all_shapes()) {
+        if (name == SHAPE_NAMES[candidate]) {
+            shape = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<AssertionShape> all_shapes() {
+    return {SHAPE_AND_CHAIN, SHAPE_OR_CHAIN, SHAPE_DELAY_CHAIN, SHAPE_RANGE_SELECT,
+            SHAPE_HUGE_DELAY, SHAPE_NESTED, SHAPE_DELAY_RANGE, SHAPE_RANDOM};
+}
+
+// splitmix64, 各平台结果一致, 便于在不同提交之间比较
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    unsigned below(unsigned bound) { return static_cast<unsigned>(next() % bound); }
+
+private:
+    uint64_t state;
+};
+
+static std::string signal(unsigned k) {
+    return "s" + std::to_string(k);
+}
+
+static std::string bits(unsigned width, Random &random) {
+    std::string text = std::to_string(width) + "'b";
+    for (unsigned i = 0; i < width; i++) {
+        text += static_cast<char>('0' + random.below(2));
+    }
+    return text;
+}
+
+// 随机叶子: 信号, 位选择, 范围比较
+static std::string random_leaf(unsigned k, Random &random) {
+    switch (random.below(4)) {
+        case 0:
+            return signal(k) + "[" + std::to_string(random.below(8)) + "]";
+        case 1: {
+            unsigned lsb = random.below(8);
+            unsigned width = 1 + random.below(8);
+            return "(" + signal(k) + "[" + std::to_string(lsb + width - 1) + ":" + std::to_string(lsb) +
+                   "] == " + bits(width, random) + ")";
+        }
+        default:
+            return signal(k);
+    }
+}
+
+std::string generate_assertion(AssertionShape shape, unsigned size, uint64_t seed) {
+    Random random(seed);
+    size = size == 0 ? 1 : size;
+    std::string text = "(";
+    switch (shape) {
+        case SHAPE_AND_CHAIN:
+        case SHAPE_OR_CHAIN:
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    text += shape == SHAPE_AND_CHAIN ? " && " : " || ";
+                }
+                text += signal(k);
+            }
+            break;
+        case SHAPE_DELAY_CHAIN:
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    text += " ##" + std::to_string(1 + random.below(3)) + " ";
+                }
+                text += signal(k);
+            }
+            break;
+        case SHAPE_RANGE_SELECT:
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    text += " && ";
+                }
+                text += "(bus" + std::to_string(k) + "[63:0] == " + bits(64, random) + ")";
+            }
+            break;
+        case SHAPE_HUGE_DELAY:
+            text += "req |-> ";
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    text += " ##" + std::to_string(100000 + random.below(1000)) + " ";
+                }
+                text += signal(k);
+            }
+            break;
+        case SHAPE_NESTED:
+            text.append(size - 1, '(');
+            text += signal(0);
+            for (unsigned k = 1; k < size; k++) {
+                text += (k % 2 ? " && " : " || ") + signal(k) + ")";
+            }
+            break;
+        case SHAPE_DELAY_RANGE:
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    unsigned low = random.below(2);
+                    text += " ##[" + std::to_string(low) + ":" + std::to_string(low + 1 + random.below(3)) + "] ";
+                }
+                text += signal(k);
+                if (random.below(4) == 0) {
+                    text += "[*1:" + std::to_string(1 + random.below(3)) + "]";
+                }
+            }
+            break;
+        case SHAPE_RANDOM: {
+            static const char *const OPERATORS[] = {" && ", " || ", " ##1 ", " ##2 ", " && ", " || "};
+            unsigned open = 0;
+            for (unsigned k = 0; k < size; k++) {
+                if (k != 0) {
+                    text += OPERATORS[random.below(6)];
+                }
+                while (k + 1 < size && random.below(4) == 0) {
+                    text += "(";
+                    open++;
+                }
+                text += random_leaf(k, random);
+                while (open != 0 && random.below(3) == 0) {
+                    text += ")";
+                    open--;
+                }
+            }
+            text.append(open, ')');
+            break;
+        }
+    }
+    return text + ")";
+}
+
+std::string generate_module(const std::string &module, const std::string &assertion) {
+    return "module " + module + "(input clk);\n"
+           "    assert property " + assertion + ";\n"
+           "endmodule\n";
+}
@@ -0,0 +1,33 @@
+//
+// 合成 SVA 断言, 供基准测试使用. 每种形状针对翻译器的一个压力点:
+// 长 &&/|| 链 (解析栈深度), 长 ##N 序列 (时刻偏移), 宽 RangeSelect, 巨大的延迟, 嵌套的延时区间
+// 和重复 (辅助定义的规模), 以及随机混合.
+// 生成的文本可以直接交给 tokenize/build_ast, 也可以用 generate_module 包成 Verilog 文件.
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum AssertionShape {
+    SHAPE_AND_CHAIN,     // (s0 && s1 && ...)
+    SHAPE_OR_CHAIN,      // (s0 || s1 || ...)
+    SHAPE_DELAY_CHAIN,   // (s0 ##1 s1 ##3 s2 ...)
+    SHAPE_RANGE_SELECT,  // (bus0[63:0] == 64'b... && ...)
+    SHAPE_HUGE_DELAY,    // (req |-> s0 ##100000 s1 ...)
+    SHAPE_NESTED,        // ((((s0 && s1) || s2) ...)
+    SHAPE_DELAY_RANGE,   // (s0 ##[1:3] s1[*1:2] ##[0:2] s2 ...)
+    SHAPE_RANDOM,        // 上述运算符的随机组合
+};
+
+const char *shape_name(AssertionShape shape);
+// 名字无效时返回 false
+bool parse_shape(const std::string &name, AssertionShape &shape);
+std::vector<AssertionShape> all_shapes();
+
+// size 为叶子个数; 同一 (shape, size, seed) 总是得到同一个断言, 文本包含最外层括号
+std::string generate_assertion(AssertionShape shape, unsigned size, uint64_t seed = 1);
+
+// 包含该断言的完整 module, 可作为 SVA2SMT 的输入文件
+std::string generate_module(const std::string &module, const std::string &assertion);
@@ -0,0 +1,202 @@
+#include "TermSharing.h"
+#include <algorithm>
+
+// 共享子项只写名字, 其余照常展开
+class SharedEmitter : public SmtEmitter {
+public:
+    SharedEmitter(SmtSink &sink, const SmtInformation &info, const SharedTerms &terms)
+        : SmtEmitter(sink, info), terms(terms) {}
+
+protected:
+    bool substitute(const ASTNode *node, unsigned time) override {
+        if (!terms.shared(node, time)) {
+            return false;
+        }
+        terms.write_name(node, time, output());
+        return true;
+    }
+
+private:
+    const SharedTerms &terms;
+};
+
+class NullSink : public SmtSink {
+public:
+    void write(const char *data, size_t size) override {}
+};
+
+// 只展开一层: 记录引用的 Bool 子项 (节点, 时刻), 不向下展开
+class ReferenceEmitter : public SmtEmitter {
+public:
+    ReferenceEmitter(SmtSink &sink, const SmtInformation &info,
+                     std::vector<std::pair<const ASTNode *, unsigned>> &references)
+        : SmtEmitter(sink, info), references(references) {}
+
+protected:
+    bool substitute(const ASTNode *node, unsigned time) override {
+        if (!node->is_boolean()) {
+            return false;
+        }
+        references.push_back({node, time});
+        return true;
+    }
+
+private:
+    std::vector<std::pair<const ASTNode *, unsigned>> &references;
+};
+
+SharedTerms::SharedTerms(const ASTNode *root, const SmtInformation &info) : root(root), info(info) {
+    // 后序遍历, 以 "特征|子编号..." 作为哈希合并的键
+    std::unordered_map<std::string, unsigned> unique;
+    std::vector<std::pair<const ASTNode *, bool>> work{{root, false}};
+    while (!work.empty()) {
+        auto [node, visited] = work.back();
+        work.pop_back();
+        if (ids.count(node)) {
+            continue;
+        }
+        if (!visited) {
+            work.push_back({node, true});
+            for (size_t i = 0; i < node->child_count(); i++) {
+                work.push_back({node->child(i), false});
+            }
+            continue;
+        }
+        std::string structure = node->signature();
+        for (size_t i = 0; i < node->child_count(); i++) {
+            structure += "|" + std::to_string(ids.at(node->child(i)));
+        }
+        auto inserted = unique.emplace(structure, static_cast<unsigned>(unique.size()));
+        ids[node] = inserted.first->second;
+    }
+
+    // 每个 (编号, 偏移) 只向下展开一次, 否则区间嵌套时路径数按指数增长
+    offsets.resize(unique.size());
+    std::unordered_set<uint64_t> seen;
+    std::vector<std::pair<const ASTNode *, unsigned>> walk{{root, 0}};
+    while (!walk.empty()) {
+        auto [node, offset] = walk.back();
+        walk.pop_back();
+        if (!seen.insert(instance(node, offset)).second) {
+            continue;
+        }
+        offsets[ids.at(node)].push_back(offset);
+        for (size_t i = 0; i < node->child_count(); i++) {
+            for (unsigned k = 0, span = node->child_span(i, info.Time); k < span; k++) {
+                walk.push_back({node->child(i), node->child_time(i, offset) + k * TIME_CLOCK});
+            }
+        }
+    }
+    for (auto &list : offsets) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    // 引用次数: 每步的断言和每个出现的 (编号, 时刻) 按其输出中引用的 Bool 子项各计一次.
+    // 按输出计数而不是按 child_time/child_span, 区间展开会直接引用重复的操作数
+    NullSink discard;
+    std::vector<std::pair<const ASTNode *, unsigned>> references;
+    ReferenceEmitter emitter(discard, info, references);
+    std::unordered_set<uint64_t> counted;
+    std::vector<std::pair<const ASTNode *, unsigned>> pending;
+    auto count = [&]() {
+        for (const auto &[child, child_time] : references) {
+            uses[instance(child, child_time)]++;
+            pending.push_back({child, child_time});
+        }
+    };
+    for (unsigned step = 1; step < info.Time; step += TIME_CLOCK) {
+        // 与 reference 相同: 根节点不是 Bool (如括号) 时照常展开
+        references.clear();
+        if (root->is_boolean()) {
+            references.push_back({root, step});
+        } else {
+            emitter.emit(root, step);
+        }
+        count();
+    }
+    while (!pending.empty()) {
+        auto [node, time] = pending.back();
+        pending.pop_back();
+        if (!counted.insert(instance(node, time)).second) {
+            continue;
+        }
+        references.clear();
+        emitter.emit(node, time);
+        count();
+    }
+}
+
+bool SharedTerms::shared(const ASTNode *node, unsigned time) const {
+    if (!node->is_boolean()) {
+        return false;
+    }
+    auto found = uses.find(instance(node, time));
+    return found != uses.end() && found->second > 1;
+}
+
+unsigned SharedTerms::owner_step(const ASTNode *node, unsigned time) const {
+    // 偏移越大, 对应的展开步越早; 展开步从 1 开始
+    const std::vector<unsigned> &list = offsets[ids.at(node)];
+    auto it = std::upper_bound(list.begin(), list.end(), time - 1);
+    return time - *(it - 1);
+}
+
+void SharedTerms::write_name(const ASTNode *node, unsigned time, SmtSink &out) const {
+    out << "Term_" << ids.at(node) << "_" << time;
+}
+
+void SharedTerms::render(const ASTNode *node, unsigned time, SmtSink &out) const {
+    SharedEmitter emitter(out, info, *this);
+    emitter.emit(node, time);
+}
+
+void SharedTerms::define(unsigned step, SmtSink &out, std::unordered_set<uint64_t> *defined) const {
+    struct Frame {
+        const ASTNode *node;
+        unsigned time;
+        bool visited;
+    };
+    // 本步内已经定义的 (编号, 时刻), 更早的步定义过的由 owner_step 判断
+    std::unordered_set<uint64_t> local;
+    const bool partial = defined != nullptr;
+    if (!partial) {
+        defined = &local;
+    }
+    std::vector<Frame> work{{root, step, false}};
+    while (!work.empty()) {
+        Frame frame = work.back();
+        work.pop_back();
+        bool is_shared = shared(frame.node, frame.time);
+        uint64_t key = instance(frame.node, frame.time);
+        if (is_shared && ((!partial && owner_step(frame.node, frame.time) < step) || defined->count(key))) {
+            continue;
+        }
+        if (!frame.visited) {
+            work.push_back({frame.node, frame.time, true});
+            for (size_t i = frame.node->child_count(); i != 0; i--) {
+                unsigned first = frame.node->child_time(i - 1, frame.time);
+                for (unsigned k = frame.node->child_span(i - 1, info.Time); k != 0; k--) {
+                    work.push_back({frame.node->child(i - 1), first + (k - 1) * TIME_CLOCK, false});
+                }
+            }
+            continue;
+        }
+        if (is_shared) {
+            out << "(define-fun ";
+            write_name(frame.node, frame.time, out);
+            out << " () Bool ";
+            render(frame.node, frame.time, out);
+            out << ")\n";
+            defined->insert(key);
+        }
+    }
+}
+
+void SharedTerms::reference(unsigned step, SmtSink &out) const {
+    if (shared(root, step)) {
+        write_name(root, step, out);
+    } else {
+        render(root, step, out);
+    }
+}
@@ -0,0 +1,45 @@
+//
+// (子项, 时刻) 共享: 结构相同的子树编号相同, 在整个脚本中被引用多于一次的 (编号, 时刻) 只以 define-fun
+// 输出一次, 之后都以名字引用; 只被引用一次的直接写在引用处. 输出规模随不同子项的个数增长,
+// 而不是随 Time x 表达式大小增长.
+// 一个 (编号, 时刻) 由最早用到它的展开步定义, 这只取决于 AST, 所以各步可以并行独立输出.
+//
+#pragma once
+
+#include "SVA2SMT.h"
+#include "SmtEmitter.h"
+#include <unordered_map>
+#include <unordered_set>
+
+class SharedTerms {
+public:
+    SharedTerms(const ASTNode *root, const SmtInformation &info);
+
+    // 写出根节点在 step 步用到且由这一步负责定义的 define-fun, 子项先于父项.
+    // 给出 defined 时改为写出其中还没有的 (编号, 时刻) 并记入其中, 用于只含部分步的脚本
+    void define(unsigned step, SmtSink &out, std::unordered_set<uint64_t> *defined = nullptr) const;
+
+    // 写出根节点在 step 步的引用, 需先调用 define
+    void reference(unsigned step, SmtSink &out) const;
+
+    // node 在 time 时刻是否以 define-fun 共享
+    bool shared(const ASTNode *node, unsigned time) const;
+    void write_name(const ASTNode *node, unsigned time, SmtSink &out) const;
+
+private:
+    uint64_t instance(const ASTNode *node, unsigned time) const {
+        return (static_cast<uint64_t>(ids.at(node)) << 32) | time;
+    }
+    // 最早用到 node 在 time 时刻的展开步
+    unsigned owner_step(const ASTNode *node, unsigned time) const;
+    void render(const ASTNode *node, unsigned time, SmtSink &out) const;
+
+    const ASTNode *root;
+    const SmtInformation &info;
+
+    std::unordered_map<const ASTNode *, unsigned> ids;
+    // 每个编号在各次出现时相对根节点的时刻偏移, 升序
+    std::vector<std::vector<unsigned>> offsets;
+    // Bool 的 (编号, 时刻) -> 在所有展开步中被引用的次数
+    std::unordered_map<uint64_t, unsigned> uses;
+};
@@ -0,0 +1,237 @@
+//
+// ThreadPool: 固定大小的线程池, 任务按提交顺序取出执行.
+// WorkStealingPool: 每个线程有自己的任务队列, 空闲时从其他线程的队列头部窃取.
+// 任务抛出的异常不会离开工作线程: 保存第一个, 由调用线程的 wait() 重新抛出.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 执行一个任务, 返回它抛出的异常
+inline std::exception_ptr invoke_task(const std::function<void()> &task) {
+    try {
+        task();
+    } catch (...) {
+        return std::current_exception();
+    }
+    return nullptr;
+}
+
+// 取出保存的异常后抛出, 下一次 wait() 不再重复抛出
+inline void rethrow_task_error(std::exception_ptr &error) {
+    if (error) {
+        std::exception_ptr first = error;
+        error = nullptr;
+        std::rethrow_exception(first);
+    }
+}
+
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        ready.notify_one();
+    }
+
+    // 等待已提交的任务全部完成, 有任务抛出异常时在这里重新抛出第一个
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return tasks.empty() && running == 0; });
+        rethrow_task_error(error);
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                running++;
+            }
+            std::exception_ptr thrown = invoke_task(task);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (thrown && !error) {
+                error = thrown;
+            }
+            if (--running == 0 && tasks.empty()) {
+                idle.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    size_t running = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+};
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) {
+        threads = threads == 0 ? 1 : threads;
+        for (unsigned i = 0; i < threads; i++) {
+            queues.emplace_back(new Queue);
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // 析构时仍等待全部任务, 但不抛出异常; 需要知道任务是否失败的调用者先调用 wait()
+    ~WorkStealingPool() {
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    // 工作线程内提交的任务放入自己的队列尾部, 外部提交的轮流分配
+    void submit(std::function<void()> task) {
+        unsigned index = (current_pool == this) ? current_index
+                                                : next_queue.fetch_add(1) % queues.size();
+        pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued++;
+        }
+        ready.notify_one();
+    }
+
+    // 等待所有任务 (包括任务中再提交的任务) 完成, 有任务抛出异常时在这里重新抛出第一个
+    void wait() {
+        std::unique_lock<std::mutex> lock(drain());
+        rethrow_task_error(error);
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    std::unique_lock<std::mutex> drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return pending.load() == 0; });
+        return lock;
+    }
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // 先取自己队列的尾部 (最近提交, 缓存较热), 再从其他队列的头部窃取
+    bool take(unsigned self, std::function<void()> &task) {
+        for (size_t k = 0; k < queues.size(); k++) {
+            Queue &queue = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void run(unsigned self) {
+        current_pool = this;
+        current_index = self;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || queued != 0; });
+                if (queued == 0) {
+                    return;
+                }
+                queued--;
+            }
+            std::function<void()> task;
+            // queued 计数保证至少有一个任务可取
+            while (!take(self, task)) {
+                std::this_thread::yield();
+            }
+            std::exception_ptr thrown = invoke_task(task);
+            if (thrown) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = thrown;
+                }
+            }
+            if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                idle.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    size_t queued = 0;
+    bool stopping = false;
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned> next_queue{0};
+    std::exception_ptr error;
+
+    static inline thread_local WorkStealingPool *current_pool = nullptr;
+    static inline thread_local unsigned current_index = 0;
+};
@@ -0,0 +1,99 @@
+#include "Translator.h"
+#include "AstImage.h"
+#include <stdexcept>
+
+Translator::Translator(const SmtInformation &options) : base(options), info(options) {}
+
+// 丢弃上一个断言; 化简会改写 NegateRoot, 所以每个断言从 options() 重新拷贝一份
+void Translator::reset() {
+    root_node = nullptr;
+    arena.clear();
+    info = base;
+}
+
+const ASTNode *Translator::current() const {
+    if (!root_node) {
+        throw std::runtime_error("Translator: no assertion has been parsed");
+    }
+    return root_node;
+}
+
+const std::vector<Token> &Translator::tokenize(std::string_view assertion) {
+    reset();
+    text.assign(assertion.data(), assertion.size());
+    tokens = ::tokenize(text);
+    return tokens;
+}
+
+const ASTNode *Translator::parse() {
+    reset();
+    root_node = build_ast(tokens, arena);
+    return root_node;
+}
+
+const ASTNode *Translator::parse(std::string_view assertion) {
+    tokenize(assertion);
+    return parse();
+}
+
+const ASTNode *Translator::load_image(std::string_view image) {
+    reset();
+    text.clear();
+    tokens.clear();
+    root_node = load_ast_image(image, arena);
+    return root_node;
+}
+
+void Translator::save_image(const std::string &file_name) const {
+    save_ast_image(current(), file_name);
+}
+
+SimplifyStats Translator::simplify() {
+    SimplifyStats stats;
+    current();
+    root_node = ::simplify(root_node, arena, info, &stats);
+    return stats;
+}
+
+void Translator::write(SmtSink &out) const {
+    write_smt_lib2(current(), info, out);
+}
+
+void Translator::write(SmtSink &negative, SmtSink &positive) const {
+    if (!info.DualPolarity) {
+        throw std::runtime_error("Translator: DualPolarity is not set");
+    }
+    DualSink out(negative, positive);
+    write(out);
+}
+
+CnfStats Translator::write_cnf(SmtSink &out, SmtSink &map) const {
+    return ::write_cnf(current(), info, out, map);
+}
+
+BtorStats Translator::write_btor2(SmtSink &out) const {
+    return ::write_btor2(current(), info, out);
+}
+
+unsigned Translator::check_incremental(SmtSink &script, SolverProcess &solver) const {
+    return ::check_incremental(current(), info, script, solver);
+}
+
+std::string Translator::write_shards() const {
+    return ::write_shards(current(), info);
+}
+
+void Translator::translate(std::string_view assertion, SmtSink &out) {
+    parse(assertion);
+    if (info.Simplify) {
+        simplify();
+    }
+    write(out);
+}
+
+std::string Translator::translate(std::string_view assertion) {
+    std::string smt;
+    StringSink out(smt);
+    translate(assertion, out);
+    return smt;
+}
@@ -0,0 +1,66 @@
+//
+// 可嵌入的翻译接口: Translator 持有自己的选项, 断言文本, token, AST 和节点池, 不使用任何全局变量.
+// 不同线程可以同时使用各自的 Translator; 同一个 Translator 不能被多个线程同时使用.
+//
+//   Translator translator(options);
+//   std::string smt = translator.translate("(a |-> b ##2 c)");
+//
+// 需要中间结果时 (缓存键, 映像, 化简统计) 可以分步调用 tokenize -> parse -> simplify -> write.
+// 每次 tokenize/parse/load_image 都会丢弃上一个断言的 AST.
+//
+#pragma once
+
+#include "BtorWriter.h"
+#include "CnfWriter.h"
+#include "Simplify.h"
+#include "SmtWriter.h"
+
+class Translator {
+public:
+    explicit Translator(const SmtInformation &options = SmtInformation());
+    Translator(const Translator &) = delete;
+    Translator &operator=(const Translator &) = delete;
+
+    // 之后翻译的断言使用的选项; 当前断言的选项 (含化简时确定的 NegateRoot) 见 information()
+    SmtInformation &options() { return base; }
+    const SmtInformation &options() const { return base; }
+    const SmtInformation &information() const { return info; }
+
+    // 复制 assertion (property 后的 '(' 到匹配的 ')') 并做词法分析
+    const std::vector<Token> &tokenize(std::string_view assertion);
+    // 由 tokenize 的结果建 AST, 语法错误抛出 ParseError, offset 相对于 assertion
+    const ASTNode *parse();
+    const ASTNode *parse(std::string_view assertion);
+    // 由预编译映像重建 AST, 映像损坏时抛出 std::runtime_error
+    const ASTNode *load_image(std::string_view image);
+    void save_image(const std::string &file_name) const;
+    // options().Simplify 为 false 时也会化简
+    SimplifyStats simplify();
+
+    const ASTNode *root() const { return root_node; }
+    size_t node_count() const { return arena.size(); }
+
+    // 以下按当前断言和 information() 输出, 见 SmtWriter.h, CnfWriter.h 和 BtorWriter.h
+    void write(SmtSink &out) const;
+    // options().DualPolarity 时一次展开写出两种极性: NeedFalse 的取反形式到 negative, 另一种到 positive
+    void write(SmtSink &negative, SmtSink &positive) const;
+    CnfStats write_cnf(SmtSink &out, SmtSink &map) const;
+    BtorStats write_btor2(SmtSink &out) const;
+    unsigned check_incremental(SmtSink &script, SolverProcess &solver) const;
+    std::string write_shards() const;
+
+    // parse, 按 options().Simplify 化简, 再 write
+    void translate(std::string_view assertion, SmtSink &out);
+    std::string translate(std::string_view assertion);
+
+private:
+    void reset();
+    const ASTNode *current() const;
+
+    SmtInformation base;
+    SmtInformation info;
+    std::string text;  // tokens 指向这里
+    std::vector<Token> tokens;
+    AstArena arena;
+    ASTNode *root_node = nullptr;
+};
@@ -0,0 +1,189 @@
+#include "VerilogScanner.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(file_name + ": cannot open: " + strerror(errno));
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        std::string reason = strerror(errno);
+        close(fd);
+        throw std::runtime_error(file_name + ": cannot stat: " + reason);
+    }
+    if (S_ISDIR(status.st_mode)) {
+        close(fd);
+        throw std::runtime_error(file_name + ": cannot open: Is a directory");
+    }
+    size = static_cast<size_t>(status.st_size);
+    if (size != 0) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::string reason = strerror(errno);
+            close(fd);
+            throw std::runtime_error(file_name + ": cannot map: " + reason);
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(mapped);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data) {
+        munmap(const_cast<char *>(data), size);
+    }
+}
+
+static const size_t NOT_FOUND = std::string_view::npos;
+
+static bool is_ident(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+static size_t find_char(std::string_view source, char c, size_t from) {
+    if (from >= source.size()) {
+        return NOT_FOUND;
+    }
+    const void *hit = memchr(source.data() + from, c, source.size() - from);
+    return hit ? static_cast<const char *>(hit) - source.data() : NOT_FOUND;
+}
+
+static size_t find_text(std::string_view source, std::string_view text, size_t from) {
+    if (from >= source.size()) {
+        return NOT_FOUND;
+    }
+    const void *hit = memmem(source.data() + from, source.size() - from, text.data(), text.size());
+    return hit ? static_cast<const char *>(hit) - source.data() : NOT_FOUND;
+}
+
+// pos 处为注释或字符串时返回其结束位置, 否则返回 pos
+static size_t skip_comment_or_string(std::string_view source, size_t pos) {
+    if (source[pos] == '/' && pos + 1 < source.size()) {
+        if (source[pos + 1] == '/') {
+            size_t end = find_char(source, '\n', pos + 2);
+            return end == NOT_FOUND ? source.size() : end;
+        }
+        if (source[pos + 1] == '*') {
+            size_t end = find_text(source, "*/", pos + 2);
+            return end == NOT_FOUND ? source.size() : end + 2;
+        }
+    } else if (source[pos] == '"') {
+        size_t end = pos;
+        do {
+            end = find_char(source, '"', end + 1);
+        } while (end != NOT_FOUND && source[end - 1] == '\\');
+        return end == NOT_FOUND ? source.size() : end + 1;
+    }
+    return pos;
+}
+
+static size_t skip_blank(std::string_view source, size_t pos) {
+    while (pos < source.size()) {
+        if (source[pos] == ' ' || source[pos] == '\t' || source[pos] == '\r' || source[pos] == '\n') {
+            pos++;
+            continue;
+        }
+        size_t end = skip_comment_or_string(source, pos);
+        if (end == pos || source[pos] == '"') {
+            break;
+        }
+        pos = end;
+    }
+    return pos;
+}
+
+static bool is_word_at(std::string_view source, size_t pos, std::string_view word) {
+    return source.compare(pos, word.size(), word) == 0
+        && (pos == 0 || !is_ident(source[pos - 1]))
+        && (pos + word.size() >= source.size() || !is_ident(source[pos + word.size()]));
+}
+
+// open 指向 '(', 返回与之匹配的 ')' 的位置
+static size_t match_paren(std::string_view source, size_t open) {
+    unsigned depth = 0;
+    for (size_t pos = open; pos < source.size(); pos++) {
+        size_t end = skip_comment_or_string(source, pos);
+        if (end != pos) {
+            pos = end - 1;
+            continue;
+        }
+        if (source[pos] == '(') {
+            depth++;
+        } else if (source[pos] == ')' && --depth == 0) {
+            return pos;
+        }
+    }
+    return NOT_FOUND;
+}
+
+std::vector<AssertionSource> scan_assert_properties(std::string_view source) {
+    std::vector<AssertionSource> result;
+    std::string_view module;
+    unsigned line = 1;
+    size_t counted = 0;  // [0, counted) 中的换行已计入 line
+
+    // 四类候选各自用 memchr/memmem 定位, 每次处理最靠前的一个
+    size_t next_slash = find_char(source, '/', 0);
+    size_t next_quote = find_char(source, '"', 0);
+    size_t next_assert = find_text(source, "assert", 0);
+    size_t next_module = find_text(source, "module", 0);
+    size_t pos = 0;
+    for (;;) {
+        // 落在已跳过区域 (注释, 字符串, 断言) 里的候选重新定位
+        if (next_slash != NOT_FOUND && next_slash < pos) next_slash = find_char(source, '/', pos);
+        if (next_quote != NOT_FOUND && next_quote < pos) next_quote = find_char(source, '"', pos);
+        if (next_assert != NOT_FOUND && next_assert < pos) next_assert = find_text(source, "assert", pos);
+        if (next_module != NOT_FOUND && next_module < pos) next_module = find_text(source, "module", pos);
+        size_t hit = std::min({next_slash, next_quote, next_assert, next_module});
+        if (hit == NOT_FOUND) {
+            break;
+        }
+
+        if (hit == next_slash || hit == next_quote) {
+            size_t end = skip_comment_or_string(source, hit);
+            pos = end == hit ? hit + 1 : end;
+        } else if (hit == next_module) {
+            pos = hit + 6;
+            if (is_word_at(source, hit, "module")) {
+                size_t head = skip_blank(source, pos);
+                size_t tail = head;
+                while (tail < source.size() && is_ident(source[tail])) {
+                    tail++;
+                }
+                module = source.substr(head, tail - head);
+                pos = tail;
+            }
+        } else {
+            pos = hit + 6;
+            if (!is_word_at(source, hit, "assert")) {
+                continue;
+            }
+            size_t keyword = skip_blank(source, pos);
+            if (!is_word_at(source, keyword, "property")) {
+                continue;
+            }
+            size_t open = skip_blank(source, keyword + 8);
+            if (open >= source.size() || source[open] != '(') {
+                continue;
+            }
+            size_t close = match_paren(source, open);
+            if (close == NOT_FOUND) {
+                break;
+            }
+            line += static_cast<unsigned>(std::count(source.begin() + counted, source.begin() + hit, '\n'));
+            counted = hit;
+            result.push_back(AssertionSource{source.substr(open, close + 1 - open), module, line});
+            pos = close + 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,34 @@
+//
+// 从 Verilog/SystemVerilog 源文件中提取 assert property.
+// 文件整体 mmap, 用 memchr/memmem 在候选字符之间跳跃, 正确跳过 // 和 /* */ 注释以及字符串,
+// 断言可以跨多行, 返回的文本直接指向映射的内存.
+//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 只读映射整个文件, 无法打开时抛出 std::runtime_error, 消息为 "<file>: cannot open: <原因>"
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &file_name);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    std::string_view view() const { return std::string_view(data, size); }
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+};
+
+struct AssertionSource {
+    std::string_view text;    // 从 property 后的 '(' 到与之匹配的 ')'
+    std::string_view module;  // 所在的 module, 未找到时为空
+    unsigned line;            // 断言所在行, 从 1 开始
+};
+
+// 按出现顺序返回 source 中所有的 assert property, 结果指向 source
+std::vector<AssertionSource> scan_assert_properties(std::string_view source);
@@ -1,123 +1,374 @@
 //
 // Created by qin on 10/26/23.
-// Using : SVA2SMT input module output time
+// Using : SVA2SMT input module output time needfalse [options]
+//   --share-terms    emit each (subterm, time) used more than once as a define-fun
+//   --simplify       fold constants, flatten and/or chains and drop redundant operands first
+//   --jobs N         render the unrolled steps on N threads
+//   --shards K       split the steps into K standalone files (OUTPUT.shard0.smt2 ...) that can be
+//                    solved in parallel, plus OUTPUT.manifest.json listing the steps of each
+//   --parametric     emit the property once as a define-fun and apply it per step
+//   --sort NAME=SORT sort of signal NAME for --parametric, e.g. --sort data="(_ BitVec 8)"
+//   --incremental    push/assert/check-sat/pop after each step instead of the final disjunction
+//   --solver "CMD"   implies --incremental; also pipe the script into CMD (e.g. "z3 -in")
+//                    and stop at the first sat bound
+//   --prelude FILE   copy FILE (declarations of the design) to the start of the output
+//   --declare        declare-const every (signal, time) the property uses, sorts as for --parametric
+//   --cache DIR      reuse the output of an earlier run with the same tokens and options
+//   --cache-size MB  evict least recently used cache entries above this size (default: 1024)
+//   --stats          print per-phase wall time, token/node counts, peak RSS and output bytes
+//                    as JSON to stderr
+//   --trace FILE     write a Chrome trace-event file of the phases and unroll steps
+//   --format cnf     bit-blast to DIMACS CNF instead of SMT-LIB2, with a variable map
+//                    (signal bits and Assert_i) in OUTPUT.map
+//   --format btor2   write a BTOR2 transition system that monitors the property without
+//                    unrolling (for btormc, pono, ...); its size does not depend on time
+//   --dual FILE      also write the opposite polarity (needfalse flipped) to FILE from the same
+//                    unrolling; subterms shared by both are rendered once
+//   --gzip LEVEL     write OUTPUT (and the --dual file) as a gzip stream at zlib LEVEL 0-9,
+//                    e.g. zcat OUTPUT | z3 -in
+//   --gzip-thread    compress on a separate thread, overlapping the rendering
+//   --verbose        echo the extracted assertion and the parsed expression, and report the
+//                    output bandwidth
+//   --direct-io      write the output with O_DIRECT, bypassing the page cache
+//   --save-ast FILE  also store the parsed assertion as a precompiled image; passing such an
+//                    image as input skips extraction and parsing. Bypasses --cache
+//         SVA2SMT --batch [batch options] files-or-directories...  (see Batch.h)
+//         SVA2SMT --serve [serve options]                          (see Server.h)
 //
 #include "SVA2SMT.h"
-#include <assert.h>
+#include "AstImage.h"
+#include "Batch.h"
+#include "Cache.h"
+#include "FileWriter.h"
+#include "GzipWriter.h"
+#include "Profiler.h"
+#include "Server.h"
+#include "Solver.h"
+#include "Translator.h"
+#include "VerilogScanner.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <unistd.h>
 
-std::vector<Token> tokens;
-SmtInformation Smt;
-ASTNode *RootASTNode;
-
-extern ASTNode *build_ast();
-
-// Tokenize函数
-void read_parameter(int argv, char *argc[]);
-std::string get_assert_property();
-std::vector<Token> tokenize(const std::string& input);
-void write_smt_lib2();
-//// 解析方法定义
+SmtInformation read_parameter(int argv, char *argc[]);
+std::string_view get_assert_property(const SmtInformation &options, std::string_view file);
+void report_parse_error(const SmtInformation &options, std::string_view file, std::string_view source,
+                        const ParseError &error);
+void write_smt_lib2(const Translator &translator);
+void write_profile(const SmtInformation &options);
 
+// 命令行只负责读文件, 缓存和输出, 翻译本身都经过 Translator (见 Translator.h)
 int main(int argv, char *argc[]) {
-    read_parameter(argv, argc);
-    tokens = tokenize(get_assert_property());
-    RootASTNode = build_ast();
-    write_smt_lib2();
+    if (argv > 1 && std::string(argc[1]) == "--batch") {
+        return run_batch(argv - 2, argc + 2);
+    }
+    if (argv > 1 && std::string(argc[1]) == "--serve") {
+        return run_server(argv - 2, argc + 2);
+    }
+    Translator translator(read_parameter(argv, argc));
+    const SmtInformation &options = translator.options();
+    std::unique_ptr<Profiler> profiler;
+    if (options.Stats || !options.TraceFile.empty()) {
+        profiler.reset(new Profiler(!options.TraceFile.empty()));
+        Profiler::activate(profiler.get());
+    }
+    std::unique_ptr<MappedFile> input;
+    try {
+        input.reset(new MappedFile(options.InputFileName));
+    } catch (const std::runtime_error &error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    std::unique_ptr<TranslationCache> cache;
+    std::string key;
+    if (is_ast_image(input->view())) {
+        // 预编译映像不经过提取, 解析和缓存
+        ProfileScope scope("load_ast");
+        try {
+            translator.load_image(input->view());
+        } catch (const std::runtime_error &error) {
+            std::cerr << options.InputFileName << ": " << error.what() << std::endl;
+            return 1;
+        }
+    } else {
+        std::string_view source;
+        {
+            ProfileScope scope("scan");
+            source = get_assert_property(options, input->view());
+        }
+        const std::vector<Token> *tokens;
+        {
+            ProfileScope scope("tokenize");
+            tokens = &translator.tokenize(source);
+        }
+        profile_count("tokens", tokens->size());
+        // 命中时不解析, 所以要写出映像 (--save-ast) 时不经过缓存
+        if (!options.CacheDirectory.empty() && options.SolverCommand.empty() && options.Shards == 0
+            && options.Format == FORMAT_SMT_LIB2 && !options.DualPolarity && options.SaveAstFile.empty()) {
+            cache.reset(new TranslationCache(options.CacheDirectory, options.CacheLimit));
+            key = TranslationCache::key(*tokens, options);
+            if (cache->fetch(key, options.OutputFileName)) {
+                auto [hits, misses] = cache->commit_counters();
+                std::cerr << "cache hit " << key << " (" << hits << " hits, " << misses << " misses)" << std::endl;
+                write_profile(options);
+                return 0;
+            }
+            // 输出文件可能是旧条目的硬链接, 先断开再写
+            unlink(options.OutputFileName.c_str());
+        }
+        {
+            ProfileScope scope("build_ast");
+            try {
+                translator.parse();
+            } catch (const ParseError &error) {
+                report_parse_error(options, input->view(), source, error);
+                return 1;
+            }
+        }
+        if (!options.SaveAstFile.empty()) {
+            ProfileScope scope("save_ast");
+            try {
+                translator.save_image(options.SaveAstFile);
+            } catch (const std::runtime_error &error) {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+    profile_count("nodes", translator.node_count());
+    if (options.Simplify) {
+        ProfileScope scope("simplify");
+        SimplifyStats stats = translator.simplify();
+        profile_count("simplify_removed", stats.removed());
+        std::cerr << "simplify: removed " << stats.removed() << " of " << stats.nodes_before << " nodes" << std::endl;
+    }
+    {
+        ProfileScope scope("write_smt_lib2");
+        write_smt_lib2(translator);
+    }
+    if (cache) {
+        cache->store(key, options.OutputFileName);
+        auto [hits, misses] = cache->commit_counters();
+        std::cerr << "cache miss " << key << " (" << hits << " hits, " << misses << " misses)" << std::endl;
+    }
+    write_profile(options);
     return 0;
 }
 
-void read_parameter(int argv,char *argc[]) {
-    assert(argv == 6);
-    Smt.InputFileName = argc[1];
-    Smt.ModuleName = argc[2];
-    Smt.OutputFileName = argc[3];
-    Smt.Time = atoi(argc[4]);
-    Smt.NeedFalse = atoi(argc[5]) == 0;
+SmtInformation read_parameter(int argv, char *argc[]) {
+    SmtInformation options;
+    if (argv < 6) {
+        std::cerr << "usage: " << argc[0] << " input module output time needfalse [options]" << std::endl;
+        exit(1);
+    }
+    options.InputFileName = argc[1];
+    options.ModuleName = argc[2];
+    options.OutputFileName = argc[3];
+    options.Time = atoi(argc[4]);
+    options.NeedFalse = atoi(argc[5]) == 0;
+    for (int i = 6; i < argv; i++) {
+        std::string option = argc[i];
+        if (option == "--share-terms") {
+            options.ShareTerms = true;
+        } else if (option == "--simplify") {
+            options.Simplify = true;
+        } else if (option == "--jobs" && i + 1 < argv) {
+            options.Jobs = std::max(1, atoi(argc[++i]));
+        } else if (option == "--shards" && i + 1 < argv) {
+            options.Shards = std::max(1, atoi(argc[++i]));
+        } else if (option == "--parametric") {
+            options.Parametric = true;
+        } else if (option == "--incremental") {
+            options.Incremental = true;
+        } else if (option == "--solver" && i + 1 < argv) {
+            options.Incremental = true;
+            options.SolverCommand = argc[++i];
+        } else if (option == "--declare") {
+            options.Declare = true;
+        } else if (option == "--prelude" && i + 1 < argv) {
+            options.PreludeFile = argc[++i];
+        } else if (option == "--cache" && i + 1 < argv) {
+            options.CacheDirectory = argc[++i];
+        } else if (option == "--cache-size" && i + 1 < argv) {
+            options.CacheLimit = strtoull(argc[++i], nullptr, 10) << 20;
+        } else if (option == "--stats") {
+            options.Stats = true;
+        } else if (option == "--trace" && i + 1 < argv) {
+            options.TraceFile = argc[++i];
+        } else if (option == "--format" && i + 1 < argv &&
+                   (!strcmp(argc[i + 1], "smt2") || !strcmp(argc[i + 1], "cnf") || !strcmp(argc[i + 1], "btor2"))) {
+            std::string format = argc[++i];
+            options.Format = format == "cnf" ? FORMAT_CNF : format == "btor2" ? FORMAT_BTOR2 : FORMAT_SMT_LIB2;
+        } else if (option == "--dual" && i + 1 < argv) {
+            options.DualPolarity = true;
+            options.DualOutputFileName = argc[++i];
+        } else if (option == "--gzip" && i + 1 < argv) {
+            options.GzipLevel = std::min(9, std::max(0, atoi(argc[++i])));
+        } else if (option == "--gzip-thread") {
+            options.GzipThread = true;
+        } else if (option == "--verbose") {
+            options.Verbose = true;
+        } else if (option == "--direct-io") {
+            options.DirectIo = true;
+        } else if (option == "--save-ast" && i + 1 < argv) {
+            options.SaveAstFile = argc[++i];
+        } else if (option == "--sort" && i + 1 < argv && strchr(argc[i + 1], '=')) {
+            std::string binding = argc[++i];
+            size_t equal = binding.find('=');
+            options.SignalSorts[binding.substr(0, equal)] = binding.substr(equal + 1);
+        } else {
+            std::cerr << "unknown option: " << option << std::endl;
+            exit(1);
+        }
+    }
+    if (options.Shards != 0 && !options.SolverCommand.empty()) {
+        std::cerr << "--shards cannot be combined with --solver" << std::endl;
+        exit(1);
+    }
+    if (options.GzipLevel >= 0 && options.Shards != 0) {
+        std::cerr << "--gzip cannot be combined with --shards" << std::endl;
+        exit(1);
+    }
+    if (options.DualPolarity && (options.Format != FORMAT_SMT_LIB2 || !options.SolverCommand.empty() || options.Shards != 0)) {
+        std::cerr << "--dual cannot be combined with --format cnf/btor2, --solver or --shards" << std::endl;
+        exit(1);
+    }
+    if (options.Format == FORMAT_CNF && options.Time < 2) {
+        std::cerr << "--format cnf needs time >= 2, no step would be checked" << std::endl;
+        exit(1);
+    }
+    if (options.Format != FORMAT_SMT_LIB2 && (options.Incremental || options.Shards != 0 || !options.PreludeFile.empty())) {
+        std::cerr << "--format " << (options.Format == FORMAT_CNF ? "cnf" : "btor2")
+                  << " cannot be combined with --incremental, --solver, --shards or --prelude" << std::endl;
+        exit(1);
+    }
+    return options;
+}
+
+// 以 文件:行:列 报告解析错误, error.offset() 相对于 source
+void report_parse_error(const SmtInformation &options, std::string_view file, std::string_view source,
+                        const ParseError &error) {
+    size_t offset = static_cast<size_t>(source.data() - file.data()) + error.offset();
+    size_t line = 1 + std::count(file.begin(), file.begin() + offset, '\n');
+    size_t line_start = file.rfind('\n', offset == 0 ? 0 : offset - 1);
+    size_t column = offset - (line_start == std::string_view::npos || offset == 0 ? 0 : line_start + 1) + 1;
+    std::cerr << options.InputFileName << ":" << line << ":" << column << ": error: " << error.message() << std::endl;
 }
 
-std::string get_assert_property() {
-    std::fstream VerilogFile(Smt.InputFileName);
-    std::string result = "";
-    std::string code;
-    std::string str("assert property");
-    std::string expand("//");
-    while(getline(VerilogFile, code)) {
-        if (code.find(str) != std::string::npos && code.find(expand) == std::string::npos) {
-            size_t head, tail;
-            for (size_t i = 0; i < code.size(); i++) {
-                if (code[i] == '(') {
-                    head = i;
-                    break;
-                }
-            }
-            for (size_t i = code.size(); i != 0; i--) {
-                if (code[i-1] == ')') {
-                    tail = i;
-                    break;
-                }
-            }
-            result = std::string(code, head, tail - head);
-            break;
-        }
+std::string_view get_assert_property(const SmtInformation &options, std::string_view file) {
+    std::vector<AssertionSource> properties = scan_assert_properties(file);
+    if (properties.empty()) {
+        std::cerr << options.InputFileName << ": there must be a assert property in Verilog file!" << std::endl;
+        exit(1);
+    }
+    std::string_view result = properties.front().text;
+    if (options.Verbose) {
+        std::cerr << result << std::endl;
     }
-    VerilogFile.close();
-    assert(!result.empty() && "there must be a assert property in Verilog file!");
-    std::cerr << result << std::endl;
     return result;
 }
 
-// Tokenize函数
-std::vector<Token> tokenize(const std::string& input) {
-    std::vector<Token> tokens;
+// 输出文件: 经 AsyncFileSink 写出, --gzip 时先经过 GzipSink 压缩
+class OutputFile {
+public:
+    OutputFile(const SmtInformation &options, const std::string &file_name)
+        : options(options), file(file_name, options.DirectIo) {
+        if (options.GzipLevel >= 0) {
+            gzip.reset(new GzipSink(file, options.GzipLevel, options.GzipThread));
+        }
+    }
 
-    std::string str = input;
+    SmtSink &sink() { return gzip ? static_cast<SmtSink &>(*gzip) : file; }
 
-    while (!str.empty()) {
-        std::smatch match;
-        Token token;
-        bool found = false;
-        for (int i = 0; i < TOKEN_TYPE_NUM; i++) {
-            if (std::regex_search(str.cbegin(), str.cend(), match, regexPatterns[i])) {
-                Token token;
-                if (!match.empty()) {
-                    std::string fix_token = match[0];
-                    if (str.find(fix_token) == 0) {
-                        token.type = static_cast<TokenType>(i);
-                        token.value = fix_token;
-                        tokens.push_back(token);
-                        str.erase(0, fix_token.length());
-                        found = true;
-                        break;
-                    }
-                }
-            }
+    // 结束压缩流并关闭文件, 记录并 (--verbose 时) 报告写出速度
+    void close() {
+        if (gzip) {
+            gzip->finish();
         }
-        if (!found) {
-            str.erase(0, 1);
+        file.close();
+        profile_count("output_mb_per_s", static_cast<unsigned long long>(file.bandwidth()));
+        if (gzip) {
+            profile_count("uncompressed_bytes", gzip->bytes_in());
+        }
+        if (options.Verbose) {
+            std::cerr << "output: " << file.bytes() << " bytes in " << file.seconds() << " s ("
+                      << file.bandwidth() << " MB/s)";
+            if (gzip) {
+                std::cerr << ", compressed from " << gzip->bytes_in() << " bytes";
+            }
+            std::cerr << std::endl;
         }
     }
-    return tokens;
-}
 
-void write_smt_lib2() {
-    std::cout << RootASTNode->to_string() << std::endl;
-    std::ofstream out(Smt.OutputFileName);
-    for (size_t i = 1; i < Smt.Time; i+=2) {
-        std::string assertName = "Assert_" + std::to_string(i);
-        std::string smtExpr = RootASTNode->to_smt_lib2(i);
-        out << "(declare-const " << assertName << " " << "Bool)" << std::endl;
-        if (Smt.NeedFalse && !RootASTNode->has_overlap()) {
-            out << "(assert (= " << assertName << " (not " << smtExpr << ")))" << std::endl;
+private:
+    const SmtInformation &options;
+    AsyncFileSink file;
+    std::unique_ptr<GzipSink> gzip;
+};
+
+void write_smt_lib2(const Translator &translator) {
+    const SmtInformation &options = translator.information();
+    if (options.Verbose) {
+        std::cout << translator.root()->to_string() << std::endl;
+    }
+    if (options.Shards != 0) {
+        try {
+            std::string manifest = translator.write_shards();
+            std::cerr << "manifest " << manifest << std::endl;
+        } catch (const std::runtime_error &error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
+        }
+        return;
+    }
+    try {
+        OutputFile out(options, options.OutputFileName);
+        if (options.Format == FORMAT_CNF) {
+            std::ofstream map_file(options.OutputFileName + ".map");
+            StreamSink map(map_file);
+            CnfStats stats = translator.write_cnf(out.sink(), map);
+            std::cerr << "cnf: " << stats.variables << " variables, " << stats.clauses << " clauses" << std::endl;
+        } else if (options.Format == FORMAT_BTOR2) {
+            BtorStats stats = translator.write_btor2(out.sink());
+            std::cerr << "btor2: " << stats.nodes << " nodes, " << stats.states << " states, window "
+                      << stats.window << " cycles" << std::endl;
+        } else if (options.DualPolarity) {
+            OutputFile other(options, options.DualOutputFileName);
+            if (options.NeedFalse) {
+                translator.write(out.sink(), other.sink());
+            } else {
+                translator.write(other.sink(), out.sink());
+            }
+            other.close();
+        } else if (options.SolverCommand.empty()) {
+            translator.write(out.sink());
         } else {
-            out << "(assert (= " << assertName << " " << smtExpr << "))" << std::endl;
+            SolverProcess solver(options.SolverCommand);
+            unsigned bound = translator.check_incremental(out.sink(), solver);
+            if (bound == 0) {
+                std::cout << "no sat bound below " << options.Time << std::endl;
+            }
         }
+        out.close();
+    } catch (const std::runtime_error &error) {
+        std::cerr << error.what() << std::endl;
+        exit(1);
+    }
+}
+
+void write_profile(const SmtInformation &options) {
+    Profiler *profiler = Profiler::active();
+    if (!profiler) {
+        return;
+    }
+    std::ifstream output(options.OutputFileName, std::ios::binary | std::ios::ate);
+    profile_count("output_bytes", output ? static_cast<unsigned long long>(output.tellg()) : 0);
+    if (options.Stats) {
+        profiler->write_stats(std::cerr);
     }
-    out << "(assert (= true (or";
-    for (size_t i = 1; i < Smt.Time; i+=2) {
-        std::string assertName = "Assert_" + std::to_string(i);
-        out << " " << assertName;
+    if (!options.TraceFile.empty()) {
+        std::ofstream trace(options.TraceFile);
+        profiler->write_trace(trace);
     }
-    out << ")))" << std::endl;
-    out.close();
 }
@@ -0,0 +1,34 @@
+#
+# --save-ast 写出的映像作为输入时跳过解析, 两次的输出都须与 EXPECTED 逐字节相同.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DWORK_DIR=<目录> -DEXPECTED=<期望输出> -P ast_round_trip.cmake
+#
+get_filename_component(name ${INPUT} NAME_WE)
+set(image ${WORK_DIR}/${name}.ast)
+file(REMOVE ${image})
+
+foreach(pass source image)
+    if(pass STREQUAL "source")
+        set(arguments ${INPUT} ${MODULE} ${WORK_DIR}/${name}.${pass}.smt2 ${TIME} ${NEEDFALSE} --save-ast ${image})
+    else()
+        set(arguments ${image} ${MODULE} ${WORK_DIR}/${name}.${pass}.smt2 ${TIME} ${NEEDFALSE})
+    endif()
+    execute_process(
+        COMMAND ${SVA2SMT} ${arguments}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "SVA2SMT (${pass}) exited with ${result}:\n${errors}")
+    endif()
+    if(NOT EXISTS ${image})
+        message(FATAL_ERROR "--save-ast did not write ${image}")
+    endif()
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK_DIR}/${name}.${pass}.smt2 ${EXPECTED}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "output from the ${pass} differs from ${EXPECTED}")
+    endif()
+endforeach()
@@ -0,0 +1,40 @@
+#
+# --cache: 第一次未命中并保存条目, 第二次命中; --cache-size 0 时条目保存后立即被淘汰, 第二次仍未命中.
+# 每次的输出都须与 EXPECTED 逐字节相同.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DWORK_DIR=<目录> -DEXPECTED=<期望输出> -P cache_reuse.cmake
+#
+get_filename_component(name ${INPUT} NAME_WE)
+
+# run(缓存目录 期望的 hit/miss [选项...])
+function(run directory outcome)
+    set(output ${directory}.${name}.smt2)
+    execute_process(
+        COMMAND ${SVA2SMT} ${INPUT} ${MODULE} ${output} ${TIME} ${NEEDFALSE} --cache ${directory} ${ARGN}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+    endif()
+    if(NOT errors MATCHES "cache ${outcome} ")
+        message(FATAL_ERROR "expected a cache ${outcome} in ${directory}, got:\n${errors}")
+    endif()
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${output} ${EXPECTED}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "output after a cache ${outcome} differs from ${EXPECTED}")
+    endif()
+endfunction()
+
+set(cache ${WORK_DIR}/cache)
+file(REMOVE_RECURSE ${cache})
+run(${cache} miss)
+run(${cache} hit)
+
+set(evicting ${WORK_DIR}/cache_evicting)
+file(REMOVE_RECURSE ${evicting})
+run(${evicting} miss --cache-size 0)
+run(${evicting} miss --cache-size 0)
@@ -0,0 +1,21 @@
+#
+# 翻译 INPUT, 输出须与 EXPECTED 逐字节相同.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v 或映像> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DOUTPUT=<输出> -DEXPECTED=<期望输出> [-DOPTIONS=<选项列表>] -P compare_output.cmake
+#
+execute_process(
+    COMMAND ${SVA2SMT} ${INPUT} ${MODULE} ${OUTPUT} ${TIME} ${NEEDFALSE} ${OPTIONS}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+endif()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${EXPECTED}
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${OUTPUT} differs from ${EXPECTED}")
+endif()
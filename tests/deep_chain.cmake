@@ -0,0 +1,31 @@
+#
+# 用 sva2smt_bench 生成很深的断言 (机器生成的长链和嵌套), 翻译须成功且有输出.
+# 递归实现会耗尽调用栈, 平方复杂度的实现会超过 ctest 的 TIMEOUT.
+#   cmake -DSVA2SMT=<程序> -DGENERATOR=<sva2smt_bench> -DNAME=<测试名> -DSHAPE=<形状> -DSIZE=<规模>
+#         -DWORK_DIR=<目录> [-DOPTIONS=<选项列表>] -P deep_chain.cmake
+#
+set(input ${WORK_DIR}/${NAME}.v)
+set(output ${WORK_DIR}/${NAME}.out)
+file(REMOVE ${output})
+
+execute_process(
+    COMMAND ${GENERATOR} --generate ${SHAPE} ${SIZE}
+    OUTPUT_FILE ${input}
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "sva2smt_bench --generate ${SHAPE} ${SIZE} exited with ${result}")
+endif()
+
+execute_process(
+    COMMAND ${SVA2SMT} ${input} bench ${output} 9 0 ${OPTIONS}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+endif()
+file(READ ${output} head LIMIT 16)
+if(head STREQUAL "")
+    message(FATAL_ERROR "${output} is empty")
+endif()
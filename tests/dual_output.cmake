@@ -0,0 +1,28 @@
+#
+# --dual 一次写出两种极性: OUTPUT 须与 NEEDFALSE 的单极性期望输出 EXPECTED 相同,
+# 另一个文件须与相反极性的 OPPOSITE 相同.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DOUTPUT=<输出> -DEXPECTED=<期望输出> -DOPPOSITE=<相反极性的期望输出>
+#         [-DOPTIONS=<选项列表>] -P dual_output.cmake
+#
+set(dual ${OUTPUT}.dual)
+execute_process(
+    COMMAND ${SVA2SMT} ${INPUT} ${MODULE} ${OUTPUT} ${TIME} ${NEEDFALSE} --dual ${dual} ${OPTIONS}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+endif()
+
+foreach(pair "${OUTPUT};${EXPECTED}" "${dual};${OPPOSITE}")
+    list(GET pair 0 actual)
+    list(GET pair 1 expected)
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${actual} ${expected}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${actual} differs from ${expected}")
+    endif()
+endforeach()
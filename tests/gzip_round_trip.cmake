@@ -0,0 +1,31 @@
+#
+# --gzip 写出的流经 gzip -d 解压后须与 EXPECTED 逐字节相同.
+#   cmake -DSVA2SMT=<程序> -DGZIP=<gzip> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DOUTPUT=<输出> -DEXPECTED=<期望输出> -DOPTIONS=<选项列表> -P gzip_round_trip.cmake
+#
+execute_process(
+    COMMAND ${SVA2SMT} ${INPUT} ${MODULE} ${OUTPUT} ${TIME} ${NEEDFALSE} ${OPTIONS}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+endif()
+
+execute_process(
+    COMMAND ${GZIP} -dc ${OUTPUT}
+    OUTPUT_FILE ${OUTPUT}.plain
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "gzip -d ${OUTPUT} exited with ${result}:\n${errors}")
+endif()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT}.plain ${EXPECTED}
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${OUTPUT} decompressed differs from ${EXPECTED}")
+endif()
@@ -0,0 +1,9 @@
+(declare-const Assert_1 Bool)
+(assert (= Assert_1 (and (= testbench.top_instance.req_1_1 #b1) (not (and (and (bvuge testbench.top_instance.gnt_3_1 #b01) testbench.top_instance.busy_3_1) (not testbench.top_instance.done_5_1))))))
+(declare-const Assert_3 Bool)
+(assert (= Assert_3 (and (= testbench.top_instance.req_3_1 #b1) (not (and (and (bvuge testbench.top_instance.gnt_5_1 #b01) testbench.top_instance.busy_5_1) (not testbench.top_instance.done_7_1))))))
+(declare-const Assert_5 Bool)
+(assert (= Assert_5 (and (= testbench.top_instance.req_5_1 #b1) (not (and (and (bvuge testbench.top_instance.gnt_7_1 #b01) testbench.top_instance.busy_7_1) (not testbench.top_instance.done_9_1))))))
+(declare-const Assert_7 Bool)
+(assert (= Assert_7 (and (= testbench.top_instance.req_7_1 #b1) (not (and (and (bvuge testbench.top_instance.gnt_9_1 #b01) testbench.top_instance.busy_9_1) (not testbench.top_instance.done_11_1))))))
+(assert (= true (or Assert_1 Assert_3 Assert_5 Assert_7)))
@@ -0,0 +1,4 @@
+module top(input clk, input req, input [1:0] gnt, input busy, input done);
+  // 请求后的下一个周期必须给出授权, 再下一个周期完成
+  assert property ((req == 1'b1) |=> (((gnt >= 2'b01) && busy) ##1 done));
+endmodule
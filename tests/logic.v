@@ -0,0 +1,3 @@
+module top(input clk, input a, input b, input c, input d);
+  assert property ((((a && b) && c) || (d && (a || c))) ##3 (b || d));
+endmodule
@@ -0,0 +1,11 @@
+#!/bin/sh
+#
+# 假的求解器: 每读一行脚本先输出大量空行, 对 check-sat 回答 unsat.
+# 不在写脚本的同时读它的输出时, 双方都会阻塞在写满的管道上.
+#
+while IFS= read -r line; do
+    head -c 200000 /dev/zero | tr '\0' '\n'
+    case "$line" in
+        *check-sat*) echo unsat ;;
+    esac
+done
@@ -0,0 +1,10 @@
+(define-fun Property ((|a@0| Bool) (|b@0| Bool) (|b@2| Bool) (|c@6| Bool) (|c@8| Bool) (|c@2| Bool)) Bool (and (and |a@0| (not (and (and |b@0| |b@2|) (not (and |c@6| |c@8|))))) (or (and |b@0| (not |c@2|)) |a@0|)))
+(declare-const Assert_1 Bool)
+(assert (= Assert_1 (Property testbench.top_instance.a_1_1 testbench.top_instance.b_1_1 testbench.top_instance.b_3_1 testbench.top_instance.c_7_1 testbench.top_instance.c_9_1 testbench.top_instance.c_3_1)))
+(declare-const Assert_3 Bool)
+(assert (= Assert_3 (Property testbench.top_instance.a_3_1 testbench.top_instance.b_3_1 testbench.top_instance.b_5_1 testbench.top_instance.c_9_1 testbench.top_instance.c_11_1 testbench.top_instance.c_5_1)))
+(declare-const Assert_5 Bool)
+(assert (= Assert_5 (Property testbench.top_instance.a_5_1 testbench.top_instance.b_5_1 testbench.top_instance.b_7_1 testbench.top_instance.c_11_1 testbench.top_instance.c_13_1 testbench.top_instance.c_7_1)))
+(declare-const Assert_7 Bool)
+(assert (= Assert_7 (Property testbench.top_instance.a_7_1 testbench.top_instance.b_7_1 testbench.top_instance.b_9_1 testbench.top_instance.c_13_1 testbench.top_instance.c_15_1 testbench.top_instance.c_9_1)))
+(assert (= true (or Assert_1 Assert_3 Assert_5 Assert_7)))
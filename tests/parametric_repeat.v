@@ -0,0 +1,3 @@
+module top(input clk, input a, input b, input c);
+  assert property ((a |-> (b[*2] ##2 c[*2])) && ((b[*1] ##1 c) || a));
+endmodule
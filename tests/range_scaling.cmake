@@ -0,0 +1,29 @@
+#
+# 区间的上界为 $ 时宽度随展开界增长. 每步的展开与区间宽度成线性, 总规模对 TIME 为平方 (界加倍约 4 倍);
+# 每个结束周期各列一个窗口时为立方 (约 8 倍). 界加倍后输出超过 5 倍即失败.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DWORK_DIR=<目录>
+#         [-DOPTIONS=<选项列表>] -P range_scaling.cmake
+#
+get_filename_component(name ${INPUT} NAME_WE)
+string(REPLACE ";" "" suffix "${OPTIONS}")
+math(EXPR double "${TIME} * 2")
+
+foreach(time ${TIME} ${double})
+    set(output ${WORK_DIR}/${name}${suffix}.${time}.out)
+    execute_process(
+        COMMAND ${SVA2SMT} ${INPUT} ${MODULE} ${output} ${time} 0 ${OPTIONS}
+        RESULT_VARIABLE result
+        OUTPUT_QUIET
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "SVA2SMT (time ${time}) exited with ${result}:\n${errors}")
+    endif()
+    file(READ ${output} content)
+    string(LENGTH "${content}" size_${time})
+endforeach()
+
+math(EXPR limit "${size_${TIME}} * 5")
+if(size_${double} GREATER limit)
+    message(FATAL_ERROR "output grows from ${size_${TIME}} to ${size_${double}} bytes when time doubles")
+endif()
@@ -0,0 +1,12 @@
+(define-fun Term_2_7 () Bool (or testbench.top_instance.d_7_1 testbench.top_instance.a_7_1))
+(declare-const Assert_1 Bool)
+(assert (= Assert_1 (and (and testbench.top_instance.a_1_1 (not (or testbench.top_instance.b_3_1 testbench.top_instance.b_5_1 testbench.top_instance.b_7_1))) (not (and (and testbench.top_instance.c_1_1 testbench.top_instance.c_3_1) (not (or (or testbench.top_instance.d_5_1 testbench.top_instance.a_5_1) (and testbench.top_instance.c_5_1 Term_2_7))))))))
+(define-fun Term_2_9 () Bool (or testbench.top_instance.d_9_1 testbench.top_instance.a_9_1))
+(declare-const Assert_3 Bool)
+(assert (= Assert_3 (and (and testbench.top_instance.a_3_1 (not (or testbench.top_instance.b_5_1 testbench.top_instance.b_7_1 testbench.top_instance.b_9_1))) (not (and (and testbench.top_instance.c_3_1 testbench.top_instance.c_5_1) (not (or Term_2_7 (and testbench.top_instance.c_7_1 Term_2_9))))))))
+(define-fun Term_2_11 () Bool (or testbench.top_instance.d_11_1 testbench.top_instance.a_11_1))
+(declare-const Assert_5 Bool)
+(assert (= Assert_5 (and (and testbench.top_instance.a_5_1 (not (or testbench.top_instance.b_7_1 testbench.top_instance.b_9_1 testbench.top_instance.b_11_1))) (not (and (and testbench.top_instance.c_5_1 testbench.top_instance.c_7_1) (not (or Term_2_9 (and testbench.top_instance.c_9_1 Term_2_11))))))))
+(declare-const Assert_7 Bool)
+(assert (= Assert_7 (and (and testbench.top_instance.a_7_1 (not (or testbench.top_instance.b_9_1 testbench.top_instance.b_11_1 testbench.top_instance.b_13_1))) (not (and (and testbench.top_instance.c_7_1 testbench.top_instance.c_9_1) (not (or Term_2_11 (and testbench.top_instance.c_11_1 (or testbench.top_instance.d_13_1 testbench.top_instance.a_13_1)))))))))
+(assert (= true (or Assert_1 Assert_3 Assert_5 Assert_7)))
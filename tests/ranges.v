@@ -0,0 +1,3 @@
+module top(input clk, input a, input b, input c, input d);
+  assert property ((a ##[1:3] b) |-> (c[*2:3] ##1 (d || a)));
+endmodule
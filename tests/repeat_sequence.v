@@ -0,0 +1,3 @@
+module top(input clk, input a, input b, input c);
+  assert property (((a ##1 b)[*2]) |-> c);
+endmodule
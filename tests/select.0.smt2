@@ -0,0 +1,9 @@
+(declare-const Assert_1 Bool)
+(assert (= Assert_1 (and (and testbench.top_instance.a_1_1 (= (_ extract 3 3 (testbench.top_instance.b_1_1)) #b1)) (not (and (distinct (_ extract 7 4 (testbench.top_instance.c_1_1)) #b0011) (not (or testbench.top_instance.d_5_1 testbench.top_instance.e_5_1)))))))
+(declare-const Assert_3 Bool)
+(assert (= Assert_3 (and (and testbench.top_instance.a_3_1 (= (_ extract 3 3 (testbench.top_instance.b_3_1)) #b1)) (not (and (distinct (_ extract 7 4 (testbench.top_instance.c_3_1)) #b0011) (not (or testbench.top_instance.d_7_1 testbench.top_instance.e_7_1)))))))
+(declare-const Assert_5 Bool)
+(assert (= Assert_5 (and (and testbench.top_instance.a_5_1 (= (_ extract 3 3 (testbench.top_instance.b_5_1)) #b1)) (not (and (distinct (_ extract 7 4 (testbench.top_instance.c_5_1)) #b0011) (not (or testbench.top_instance.d_9_1 testbench.top_instance.e_9_1)))))))
+(declare-const Assert_7 Bool)
+(assert (= Assert_7 (and (and testbench.top_instance.a_7_1 (= (_ extract 3 3 (testbench.top_instance.b_7_1)) #b1)) (not (and (distinct (_ extract 7 4 (testbench.top_instance.c_7_1)) #b0011) (not (or testbench.top_instance.d_11_1 testbench.top_instance.e_11_1)))))))
+(assert (= true (or Assert_1 Assert_3 Assert_5 Assert_7)))
@@ -0,0 +1,4 @@
+module top(input clk, input a, input [3:0] b, input [7:0] c, input d, input e);
+  /* 位选和区间选择 */
+  assert property ((a && (b[3] == 1'b1)) |-> ((c[7:4] != 4'b0011) ##2 (d || e)));
+endmodule
@@ -0,0 +1,64 @@
+#
+# --shards K 的各个分片依次拼接须与不分片的输出相同: 去掉各分片末尾的析取, 合并为一个;
+# 各分片重新定义自己用到的共享子项, 只保留第一次的定义.
+#   cmake -DSVA2SMT=<程序> -DINPUT=<.v> -DMODULE=<模块> -DTIME=<界> -DNEEDFALSE=<0|1>
+#         -DSHARDS=<K> -DWORK_DIR=<目录> -P shards_concat.cmake
+#
+get_filename_component(name ${INPUT} NAME_WE)
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(sharded ${WORK_DIR}/${name}.sharded)
+set(unsharded ${WORK_DIR}/${name}.unsharded.smt2)
+file(GLOB stale ${sharded}.*)
+if(stale)
+    file(REMOVE ${stale})
+endif()
+
+foreach(pass split whole)
+    if(pass STREQUAL "split")
+        set(arguments ${INPUT} ${MODULE} ${sharded}.smt2 ${TIME} ${NEEDFALSE} --shards ${SHARDS})
+    else()
+        set(arguments ${INPUT} ${MODULE} ${unsharded} ${TIME} ${NEEDFALSE})
+    endif()
+    execute_process(
+        COMMAND ${SVA2SMT} ${arguments}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "SVA2SMT (${pass}) exited with ${result}:\n${errors}")
+    endif()
+endforeach()
+if(NOT EXISTS ${sharded}.manifest.json)
+    message(FATAL_ERROR "--shards did not write ${sharded}.manifest.json")
+endif()
+
+set(combined "")
+set(steps "")
+set(defined "")
+math(EXPR last "${SHARDS} - 1")
+foreach(k RANGE ${last})
+    file(STRINGS ${sharded}.shard${k}.smt2 lines)
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^\\(assert \\(= true \\(or (.*)\\)\\)\\)$")
+            string(APPEND steps " ${CMAKE_MATCH_1}")
+        elseif(line MATCHES "^\\(define-fun ")
+            list(FIND defined "${line}" index)
+            if(index EQUAL -1)
+                list(APPEND defined "${line}")
+                string(APPEND combined "${line}\n")
+            endif()
+        else()
+            string(APPEND combined "${line}\n")
+        endif()
+    endforeach()
+endforeach()
+string(APPEND combined "(assert (= true (or${steps})))\n")
+file(WRITE ${sharded}.combined.smt2 "${combined}")
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${sharded}.combined.smt2 ${unsharded}
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "the ${SHARDS} shards combined (${sharded}.combined.smt2) differ from ${unsharded}")
+endif()
@@ -0,0 +1,29 @@
+#
+# --solver 接一个输出很多的求解器, 翻译须在 TIMEOUT 内正常结束并报告每个界的结果.
+#   cmake -DSVA2SMT=<程序> -DGENERATOR=<sva2smt_bench> -DSOLVER=<求解器脚本> -DWORK_DIR=<目录>
+#         -P solver_drain.cmake
+#
+set(input ${WORK_DIR}/solver_drain.v)
+set(output ${WORK_DIR}/solver_drain.smt2)
+
+execute_process(
+    COMMAND ${GENERATOR} --generate and_chain 20000
+    OUTPUT_FILE ${input}
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "sva2smt_bench --generate and_chain 20000 exited with ${result}")
+endif()
+
+execute_process(
+    COMMAND ${SVA2SMT} ${input} bench ${output} 5 0 --solver "sh ${SOLVER}"
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE answers
+    ERROR_VARIABLE errors
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "SVA2SMT exited with ${result}:\n${errors}")
+endif()
+if(NOT answers MATCHES "bound 3: unsat")
+    message(FATAL_ERROR "unexpected solver answers:\n${answers}")
+endif()
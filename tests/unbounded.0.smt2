@@ -0,0 +1,13 @@
+(define-fun Term_2_5 () Bool (or testbench.top_instance.d_5_1 testbench.top_instance.a_5_1))
+(define-fun Term_2_7 () Bool (or testbench.top_instance.d_7_1 testbench.top_instance.a_7_1))
+(declare-const Assert_1 Bool)
+(assert (= Assert_1 (and (and (and testbench.top_instance.a_1_1 testbench.top_instance.a_3_1) (not (or testbench.top_instance.b_3_1 testbench.top_instance.b_5_1 testbench.top_instance.b_7_1 testbench.top_instance.b_9_1 (and testbench.top_instance.a_5_1 (or testbench.top_instance.b_11_1 (and testbench.top_instance.a_7_1 testbench.top_instance.b_13_1)))))) (not (and testbench.top_instance.c_1_1 (not (or (or testbench.top_instance.d_3_1 testbench.top_instance.a_3_1) Term_2_5 Term_2_7)))))))
+(define-fun Term_2_9 () Bool (or testbench.top_instance.d_9_1 testbench.top_instance.a_9_1))
+(declare-const Assert_3 Bool)
+(assert (= Assert_3 (and (and (and testbench.top_instance.a_3_1 testbench.top_instance.a_5_1) (not (or testbench.top_instance.b_5_1 testbench.top_instance.b_7_1 testbench.top_instance.b_9_1 testbench.top_instance.b_11_1 (and testbench.top_instance.a_7_1 (or testbench.top_instance.b_13_1 (and testbench.top_instance.a_9_1 testbench.top_instance.b_15_1)))))) (not (and testbench.top_instance.c_3_1 (not (or Term_2_5 Term_2_7 Term_2_9)))))))
+(define-fun Term_2_11 () Bool (or testbench.top_instance.d_11_1 testbench.top_instance.a_11_1))
+(declare-const Assert_5 Bool)
+(assert (= Assert_5 (and (and (and testbench.top_instance.a_5_1 testbench.top_instance.a_7_1) (not (or testbench.top_instance.b_7_1 testbench.top_instance.b_9_1 testbench.top_instance.b_11_1 testbench.top_instance.b_13_1 (and testbench.top_instance.a_9_1 (or testbench.top_instance.b_15_1 (and testbench.top_instance.a_11_1 testbench.top_instance.b_17_1)))))) (not (and testbench.top_instance.c_5_1 (not (or Term_2_7 Term_2_9 Term_2_11)))))))
+(declare-const Assert_7 Bool)
+(assert (= Assert_7 (and (and (and testbench.top_instance.a_7_1 testbench.top_instance.a_9_1) (not (or testbench.top_instance.b_9_1 testbench.top_instance.b_11_1 testbench.top_instance.b_13_1 testbench.top_instance.b_15_1 (and testbench.top_instance.a_11_1 (or testbench.top_instance.b_17_1 (and testbench.top_instance.a_13_1 testbench.top_instance.b_19_1)))))) (not (and testbench.top_instance.c_7_1 (not (or Term_2_9 Term_2_11 (or testbench.top_instance.d_13_1 testbench.top_instance.a_13_1))))))))
+(assert (= true (or Assert_1 Assert_3 Assert_5 Assert_7)))
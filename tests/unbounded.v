@@ -0,0 +1,3 @@
+module top(input clk, input a, input b, input c, input d);
+  assert property ((a[*2:$] ##[0:$] b) |-> (c ##[1:$] (d || a)));
+endmodule